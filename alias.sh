@@ -3,9 +3,16 @@ alias stat='(cd  ~/git/codingG/SummerChallenge2025-SoakOverflow && java @argfile
 
 alias cgweb='google-chrome http://127.0.0.1:8888/'
 alias build='gcc main.c -Wall -o current.out'
+alias buildT='gcc -DTHREADS=8 -pthread main.c -Wall -o current.out'
+alias buildM='gcc -DMCTS main.c -Wall -o current.out -lm'
 
 alias servB0='serv ../SummerChallenge2025/current.out ../SummerChallenge2025/bot0.sh -173386750144284364 )'
 alias servB0r='serv ../SummerChallenge2025/bot0.sh ../SummerChallenge2025/current.out -173386750144284364 )'
 
 alias statB0='stat ../SummerChallenge2025/bot0.sh  ../SummerChallenge2025/current.out )'
 alias statB1='stat ../SummerChallenge2025/bot1.out  ../SummerChallenge2025/current.out )'
+
+alias bench='gcc -DBENCH main.c -Wall -o bench.out'
+alias servB0cap='serv ../SummerChallenge2025/capture.sh ../SummerChallenge2025/bot0.sh -173386750144284364 )'
+alias selfplay='gcc -DSELFPLAY main.c -Wall -o selfplay.out && ./selfplay.out'
+alias tune='gcc -DTUNE main.c -Wall -o tune.out -lm && ./tune.out'
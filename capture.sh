@@ -0,0 +1,4 @@
+# Bot courant avec copie de stdin dans transcripts/ pour le banc de test : ./bench.out < transcripts/xxx.txt
+DIR=$(dirname "$0")
+mkdir -p "$DIR/transcripts"
+tee "$DIR/transcripts/$(date +%Y%m%d_%H%M%S)_$$.txt" | "$DIR/current.out"
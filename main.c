@@ -11,6 +11,22 @@
 #include <stdbool.h>
 #include <time.h>
 #include <limits.h>
+#include <errno.h>
+#include <float.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#if defined(TUNE) || defined(MCTS)
+#include <math.h>
+#endif
+#if THREADS
+#include <pthread.h>
+#endif
 
 #define MAX_WIDTH  20
 #define MAX_HEIGHT 20
@@ -21,12 +37,111 @@
 #define MAX_BOMB_PER_AGENT 5
 #define MAX_COMMANDS_PER_AGENT 35
 #define MAX_COMMANDS_PER_PLAYER 1024
-#define MAX_SIMULATIONS 1024
+#define EVAL_TOP_K 16 // meilleures lignes de la matrice conservées
+#ifndef THREADS
+#define THREADS 0        // > 0 : matrice évaluée sur THREADS threads (analyse, self-play), lier avec -pthread
+#endif
+#ifdef BENCH
+#undef PROFILE
+#define PROFILE 1        // le banc de test lit les temps de phase
+#define FIXED_WORK       // et mesure une quantité de travail fixe
+#endif
+#ifndef PROFILE
+#define PROFILE 1        // 0 = instrumentation de timing compilée à vide
+#endif
+#define EVAL_MAXIMIN 0   // valeur d'une commande = pire cas sur les réponses ennemies
+#define EVAL_MEAN    1   // valeur d'une commande = moyenne sur les réponses ennemies
+#define EVAL_REGRET  2   // stratégie mixte approchée par regret matching (matrice remplie à la demande)
+#ifndef EVAL_MODE
+#define EVAL_MODE EVAL_MAXIMIN
+#endif
+// Le solveur de regret tire ses cases une à une : seule la matrice par tours est répartie sur les threads
+#define EVAL_POOL (THREADS && EVAL_MODE != EVAL_REGRET)
+#ifdef TUNE
+#define SELFPLAY         // le tuner joue ses parties avec le moteur du self-play
+#endif
+// Échéances des phases en ms depuis le début du tour (voir ORDONNANCEUR)
+#ifdef SELFPLAY
+// Quantités de travail fixes et réduites : une graine donne toujours la même partie, quelle que
+// soit la charge, et les parties s'enchaînent vite (surchargeables)
+#define FIXED_WORK
+#ifndef FIXED_COMBOS
+#define FIXED_COMBOS 64
+#endif
+#ifndef FIXED_MATCHUPS
+#define FIXED_MATCHUPS 512
+#endif
+#ifndef FIXED_REGRET_ITERATIONS
+#define FIXED_REGRET_ITERATIONS 512
+#endif
+#ifndef FIXED_SEARCH_DEPTH
+#define FIXED_SEARCH_DEPTH 2
+#endif
+#ifndef FIXED_MCTS_ITERATIONS
+#define FIXED_MCTS_ITERATIONS 256
+#endif
+#endif
+#ifndef JOINT_DEADLINE_MS
+#define JOINT_DEADLINE_MS 8.0
+#endif
+#ifndef EVAL_DEADLINE_MS
+#define EVAL_DEADLINE_MS 22.0
+#endif
+#ifndef SEARCH_DEADLINE_MS
+#define SEARCH_DEADLINE_MS 40.0     // plafond du tour : 10 ms de marge sur les 50 ms de l'arbitre
+#endif
+#ifndef FIRST_TURN_SCALE
+#define FIRST_TURN_SCALE 10.0       // le premier tour dispose de 1000 ms : échéances multipliées
+#endif
+#define SCHEDULE_FILL 0.8           // part du budget d'une phase visée par sa quantité de travail
+#define JOINT_MIN_COMBOS 64
+#define EVAL_MIN_MATCHUPS 1024
+#define EVAL_MAX_MATCHUPS (MAX_COMMANDS_PER_PLAYER * MAX_COMMANDS_PER_PLAYER)
+#define REGRET_ITERATIONS 4096      // itérations du solveur de regret avant la première mesure
+#define REGRET_MIN_ITERATIONS 256
+#define REGRET_MAX_ITERATIONS 65536
+#define REGRET_ITERATIONS_PER_CELL 16 // au-delà, les itérations n'apprennent plus rien de la matrice
+#define SEARCH_MAX_DEPTH 8          // tours simulés au maximum (1 = évaluation seule)
+#define SEARCH_ROOT_WIDTH 8         // meilleures lignes de la matrice reprises par la recherche
+#define SEARCH_ROOT_REPLIES 3       // réponses ennemies testées à la racine
+#define SEARCH_BRANCH (1 + MAX_AGENTS / 2) // commandes joueur générées par noeud
+#define TT_BITS 16
+#define MCTS_MAX_NODES 65536        // pool de noeuds de l'arbre MCTS (-DMCTS)
+#ifdef FIXED_WORK
+// Quantités de travail fixes par tour, sans échéance ni recalage : durée et résultat d'un tour
+// ne dépendent plus de la charge de la machine (surchargeables)
+#ifndef FIXED_COMBOS
+#define FIXED_COMBOS 256            // combinaisons explorées par joueur
+#endif
+#ifndef FIXED_MATCHUPS
+#define FIXED_MATCHUPS 4096         // matchs de la matrice au-delà desquels elle n'est plus élargie
+#endif
+#ifndef FIXED_REGRET_ITERATIONS
+#define FIXED_REGRET_ITERATIONS 4096
+#endif
+#ifndef FIXED_SEARCH_DEPTH
+#define FIXED_SEARCH_DEPTH 3
+#endif
+#ifndef FIXED_MCTS_ITERATIONS
+#define FIXED_MCTS_ITERATIONS 2048
+#endif
+#endif
+#define MCTS_MAX_DEPTH SEARCH_MAX_DEPTH
+#define MCTS_ROOT_ACTIONS 32        // combinaisons par joueur à la racine
+#define MCTS_EXPLORATION 0.7f
+#define CONTROL_FAR 127 // distance int8 "aucun agent"
+#define BB_WORDS 7       // 7 x 64 bits >= 400 tuiles
+#define TILE_BIT(x, y) ((y) * MAX_WIDTH + (x))
 
 // ==========================
 // === DATA MODELS
 // ==========================
 
+// Bitboard 20x20 : bit TILE_BIT(x, y) = tuile (x, y), les bits hors carte restent à 0
+typedef struct {
+    uint64_t w[BB_WORDS];
+} Bitboard;
+
 typedef enum {
     CMD_SHOOT,
     CMD_THROW,
@@ -50,9 +165,23 @@ typedef struct {
 } SimulationResult;
 
 typedef struct {
-    // [agent_id][y][x] = distance depuis agent_id à (x, y)
-    int bfs_enemy_distances[MAX_AGENTS][MAX_HEIGHT][MAX_WIDTH];
+    // Distances pondérées (x2 si wetness >= 50) de l'état courant, une ligne de 32 x int8 par y
+    __m256i enemy_rows[MAX_HEIGHT];                // ennemi le plus proche
+    __m256i ally_rows[MAX_HEIGHT];                 // allié le plus proche
+    __m256i others_rows[MAX_AGENTS][MAX_HEIGHT];   // allié le plus proche hors agent_id
+    int row_scores[MAX_HEIGHT];                    // tuiles à moi - tuiles ennemies par ligne
+    int base_score;                                // somme des row_scores
+
+    // bit y = la ligne y peut changer de score si l'agent fait un pas (ou reste sur place)
+    unsigned int sensitive_rows[MAX_AGENTS];
+} ControlMap;
+
+typedef struct {
+    // Carte de contrôle de la zone, reconstruite une fois par tour
+    ControlMap control;
 
+    // [y][x] = agents vivants (bit = index) dans la zone 3x3 d'une bombe visant (x, y)
+    uint16_t splash_agents[MAX_HEIGHT][MAX_WIDTH];
 
     // Listes triées des meilleurs actions par agent
     AgentAction moves[MAX_AGENTS][MAX_MOVES_PER_AGENT];
@@ -66,12 +195,22 @@ typedef struct {
     AgentCommand agent_commands[MAX_AGENTS][MAX_COMMANDS_PER_AGENT];
     int agent_command_counts[MAX_AGENTS];
 
-    // Liste des commandes fusionnées (combinaisons multi-agents) par joueur
-    AgentCommand player_commands[MAX_PLAYERS][MAX_COMMANDS_PER_PLAYER][MAX_AGENTS];
+    // Combinaisons multi-agents par joueur : un index dans agent_commands[agent_id] par agent,
+    // décodé avec player_command()
+    uint8_t player_commands[MAX_PLAYERS][MAX_COMMANDS_PER_PLAYER][MAX_AGENTS];
     int player_command_count[MAX_PLAYERS];
 
-    // Résultats de simulations triée par score pour obtenir la meilleur commande simulation_results[0].my_cmds_index
-    SimulationResult simulation_results[MAX_SIMULATIONS];
+    // Matrice de gains mes commandes x commandes ennemies : chaque ligne est évaluée
+    // sur ses row_columns premières colonnes (réponses ennemies dans l'ordre heuristique)
+    int row_columns[MAX_COMMANDS_PER_PLAYER];
+    float row_worst_values[MAX_COMMANDS_PER_PLAYER];
+    int row_worst_columns[MAX_COMMANDS_PER_PLAYER];
+    float row_sums[MAX_COMMANDS_PER_PLAYER];
+    int matrix_columns;   // colonnes évaluées pour toutes les lignes candidates
+    int matchup_count;    // simulations jouées ce tour
+
+    // Meilleures lignes, la meilleure commande en premier : simulation_results[0].my_cmds_index
+    SimulationResult simulation_results[EVAL_TOP_K];
     int simulation_count;
 } GameOutput;
 
@@ -106,6 +245,8 @@ typedef struct {
 typedef struct {
     int width, height;
     Tile map[MAX_HEIGHT][MAX_WIDTH];
+    unsigned int walkable_rows[MAX_HEIGHT]; // bit x = tuile sans obstacle (padding à 0)
+    Bitboard walkable;                      // tuiles sans obstacle
 } MapInfo;
 
 typedef struct {
@@ -130,16 +271,295 @@ typedef struct {
 
 GameInfo game = {0};
 
+// Poids des heuristiques, surchargeables par fichier "nom valeur" (PARAMS=chemin) ou par le tuner
+typedef struct {
+    float eval_control;         // zone contrôlée (/100)
+    float eval_wetness;         // wetness infligée - subie (/100)
+    float eval_wet50;           // agents passés à 50 de wetness (/10)
+    float eval_wet100;          // agents éliminés (/10)
+    float move_control;         // gain de zone d'un déplacement
+    float move_enemy_distance;  // distance BFS à l'ennemi le plus proche
+    float move_ally_penalty;    // allié trop proche quand un ennemi avec bombes menace
+    float move_ally_radius;
+    float move_danger_range;    // distance de menace d'un ennemi avec bombes
+    float shoot_optimal_bonus;  // multiplicateur de wetness de la cible à portée optimale
+    float shoot_distance;       // pénalité par case de distance au tir
+    float bomb_base;            // score d'une bombe : bomb_base - wetness de la cible
+} Params;
+#define PARAM_COUNT ((int)(sizeof(Params) / sizeof(float)))
+#define PARAMS_DEFAULT {10.0f, 100.0f, 1000.0f, 10000.0f, 10.0f, 1.0f, 20.0f, 3.0f, 7.0f, 1.5f, 2.0f, 100.0f}
+
+static const char* const param_names[PARAM_COUNT] = {
+    "eval_control", "eval_wetness", "eval_wet50", "eval_wet100",
+    "move_control", "move_enemy_distance", "move_ally_penalty", "move_ally_radius", "move_danger_range",
+    "shoot_optimal_bonus", "shoot_distance", "bomb_base"
+};
+
+Params params = PARAMS_DEFAULT;
+
+// Table de transposition : valeur d'un état pour une profondeur restante, bornes alpha-beta
+typedef enum {
+    TT_EXACT,
+    TT_LOWER,
+    TT_UPPER
+} TTBound;
+typedef struct {
+    uint64_t key;
+    float value;
+    uint8_t depth;
+    uint8_t bound;
+    uint16_t generation; // tour de la recherche : les valeurs sont relatives à l'état du tour
+} TTEntry;
+
+typedef struct {
+    // Clés de Zobrist par agent : position, wetness, cooldown, bombes, mort
+    uint64_t zobrist_position[MAX_AGENTS][MAX_HEIGHT * MAX_WIDTH];
+    uint64_t zobrist_wetness[MAX_AGENTS][101];
+    uint64_t zobrist_cooldown[MAX_AGENTS][8];
+    uint64_t zobrist_bombs[MAX_AGENTS][8];
+    uint64_t zobrist_dead[MAX_AGENTS];
+
+    TTEntry tt[1 << TT_BITS];
+    uint16_t generation;
+
+    bool timeout;
+    int depth;        // dernière profondeur complète
+    int node_count;
+    int tt_hits;
+} SearchInfo;
+
+SearchInfo search = {0};
+
+// Échéances et quantités de travail du tour courant (voir ORDONNANCEUR)
+typedef struct {
+    int turn;                   // tours planifiés depuis le début de la partie
+    double joint_ms;            // échéance de compute_best_player_commands()
+    double evaluation_ms;       // échéance de compute_evaluation()
+    double search_ms;           // échéance de compute_search() / compute_mcts()
+    int combo_budget;           // combinaisons explorées au plus par joueur
+    int matchup_budget;         // matchs de la matrice au-delà desquels elle n'est plus élargie
+    int regret_iterations;      // itérations du solveur de regret au plus
+    int search_depth;           // profondeur maximale de compute_search()
+    int mcts_iterations;        // itérations de compute_mcts() au plus
+} Schedule;
+
+Schedule schedule;
+
+void schedule_reset() {
+#ifdef FIXED_WORK
+    schedule = (Schedule){ .combo_budget = FIXED_COMBOS, .matchup_budget = FIXED_MATCHUPS,
+                           .regret_iterations = FIXED_REGRET_ITERATIONS, .search_depth = FIXED_SEARCH_DEPTH,
+                           .mcts_iterations = FIXED_MCTS_ITERATIONS };
+#else
+    schedule = (Schedule){ .combo_budget = MAX_COMMANDS_PER_PLAYER, .matchup_budget = EVAL_MAX_MATCHUPS,
+                           .regret_iterations = REGRET_ITERATIONS, .search_depth = SEARCH_MAX_DEPTH,
+                           .mcts_iterations = INT_MAX };
+#endif
+}
+
+#ifdef MCTS
+// Arbre de la recherche Monte Carlo (voir MCTS) : pools préalloués, remis à zéro à chaque tour
+typedef struct {
+    int visits;
+    int stats;                  // premier MctsStat : [0] mes actions puis [1] celles de l'ennemi
+    int children;               // premier enfant, action_counts[0] x action_counts[1] ; -1 = non développé
+    uint8_t action_counts[2];
+} MctsNode;
+
+typedef struct {
+    float value_sum;            // de mon point de vue
+    int visits;
+} MctsStat;
+
+typedef struct {
+    MctsNode nodes[MCTS_MAX_NODES];
+    MctsStat stats[MCTS_MAX_NODES * 2 * SEARCH_BRANCH];
+    int children[MCTS_MAX_NODES * SEARCH_BRANCH * SEARCH_BRANCH];
+    int node_count, stat_count, child_count;
+    float value_min, value_max;  // bornes des évaluations du tour, pour normaliser les moyennes
+    int iterations;
+} MctsInfo;
+
+MctsInfo mcts;
+#endif
+
+// Plan du tour précédent par siège, pour le démarrage à chaud (voir DÉMARRAGE À CHAUD)
+typedef struct {
+    bool valid;
+    AgentState from[MAX_AGENTS];    // état au moment du plan
+    AgentCommand plan[MAX_AGENTS];  // mes commandes et la réponse ennemie, par agent
+    uint8_t seeds[MAX_PLAYERS][MAX_AGENTS]; // plan prolongé, en index dans agent_commands
+    bool seeded[MAX_PLAYERS];
+} WarmStart;
+
+static WarmStart warm[MAX_PLAYERS];   // indexé par le siège qui a planifié
+
 // ==========================
 // === UTILITAIRES
 // ==========================
-static clock_t gCPUStart;
-#define CPU_RESET        (gCPUStart = clock())
-#define CPU_MS_USED      (((double)(clock() - gCPUStart)) * 1000.0 / CLOCKS_PER_SEC)
-#define CPU_BREAK(val)   if (CPU_MS_USED > (val)) break;
+// Temps mur depuis la lecture du début du tour : la limite de l'arbitre est en temps mur, le
+// temps CPU ne voit ni la préemption ni les attentes d'entrée/sortie
+static uint64_t gTurnStart;
+#define TURN_RESET       (gTurnStart = now_ns())
+#define TURN_MS_USED     ((double)(now_ns() - gTurnStart) / 1e6)
+#define TURN_BREAK(val)  if (TURN_MS_USED > (val)) break;
 #define ERROR(text) {fprintf(stderr,"ERROR:%s",text);fflush(stderr);exit(1);}
 #define ERROR_INT(text,val) {fprintf(stderr,"ERROR:%s:%d",text,val);fflush(stderr);exit(1);}
 
+// xorshift64* : générateur partagé (clés Zobrist, solveur de regret, moteur de self-play)
+static inline uint64_t random_next(uint64_t* state) {
+    *state ^= *state >> 12; *state ^= *state << 25; *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Insertion dans une liste bornée triée par score décroissant, les ex aequo gardent l'ordre d'arrivée.
+// Retourne false si l'élément ne fait pas partie des capacity meilleurs.
+static inline bool topk_insert(void* items, int* count, int capacity, size_t size, size_t score_offset, const void* item) {
+    char* base = items;
+    float score = *(const float*)((const char*)item + score_offset);
+    int pos = *count;
+    while (pos > 0 && *(const float*)(base + (pos - 1) * size + score_offset) < score) pos--;
+    if (pos >= capacity) return false;
+    int last = (*count < capacity) ? *count : capacity - 1;
+    memmove(base + (pos + 1) * size, base + pos * size, (last - pos) * size);
+    memcpy(base + pos * size, item, size);
+    if (*count < capacity) (*count)++;
+    return true;
+}
+// items : tableau d'une structure avec un champ float score
+#define TOPK_PUSH(items, count, capacity, item) \
+    topk_insert((items), &(count), (capacity), sizeof(item), offsetof(__typeof__(item), score), &(item))
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ==========================
+// === PROFILING
+// ==========================
+// Temps mur par phase et compteurs, une ligne "PROF key=value ..." par tour sur stderr
+typedef enum {
+    PHASE_READ,
+    PHASE_OCCUPANCY,
+    PHASE_CONTROL_MAP,
+    PHASE_AGENT_COMMANDS,
+    PHASE_PLAYER_COMMANDS,
+    PHASE_EVALUATION,
+    PHASE_SEARCH,
+    PHASE_OUTPUT,
+    PHASE_COUNT
+} ProfilePhase;
+typedef enum {
+    COUNTER_SIMULATIONS,    // tours simulés (matrice + recherche)
+    COUNTER_CONTROL_SCORES, // appels controlled_score_gain_if_agent_moves_to
+    COUNTER_EVALUATIONS,    // appels evaluate_simulation
+    COUNTER_SEARCH_NODES,
+    COUNTER_COUNT
+} ProfileCounter;
+
+typedef struct {
+    int turn;
+    uint64_t turn_start_ns;
+    uint64_t phase_ns[PHASE_COUNT];
+    uint64_t counters[COUNTER_COUNT];
+} ProfileInfo;
+
+#if PROFILE
+static const char* const profile_phase_names[PHASE_COUNT] = {
+    "read", "occupancy", "control_map", "agent_cmds", "player_cmds", "evaluation", "search", "output"
+};
+static const char* const profile_counter_names[COUNTER_COUNT] = {
+    "sims", "control_calls", "evals", "search_nodes"
+};
+
+ProfileInfo profile = {0};
+
+typedef struct {
+    ProfilePhase phase;
+    uint64_t start;
+} ProfileScope;
+
+static inline void profile_scope_end(ProfileScope* scope) {
+    profile.phase_ns[scope->phase] += now_ns() - scope->start;
+}
+
+// Chronomètre la fin du bloc courant dans la phase donnée
+#define PROFILE_SCOPE(phase) \
+    ProfileScope _profile_scope __attribute__((cleanup(profile_scope_end))) = {(phase), now_ns()}
+#if THREADS
+// Compteurs locaux au thread, reversés dans profile.counters par profile_flush_counters()
+static __thread uint64_t profile_thread_counters[COUNTER_COUNT];
+#define PROFILE_COUNT(counter, n) (profile_thread_counters[counter] += (n))
+
+static inline void profile_flush_counters() {
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        __atomic_fetch_add(&profile.counters[c], profile_thread_counters[c], __ATOMIC_RELAXED);
+        profile_thread_counters[c] = 0;
+    }
+}
+#else
+#define PROFILE_COUNT(counter, n) (profile.counters[counter] += (n))
+#define profile_flush_counters() ((void)0)
+#endif
+#define PROFILE_TURN_START() (profile.turn_start_ns = now_ns())
+
+void profile_report() {
+    profile_flush_counters();
+    uint64_t total = now_ns() - profile.turn_start_ns;
+    fprintf(stderr, "PROF turn=%d total_ns=%llu", profile.turn, (unsigned long long)total);
+    for (int p = 0; p < PHASE_COUNT; p++)
+        fprintf(stderr, " %s_ns=%llu", profile_phase_names[p], (unsigned long long)profile.phase_ns[p]);
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        fprintf(stderr, " %s=%llu", profile_counter_names[c], (unsigned long long)profile.counters[c]);
+    fprintf(stderr, " sims_per_s=%.0f\n", total ? profile.counters[COUNTER_SIMULATIONS] * 1e9 / total : 0.0);
+
+    profile.turn++;
+    memset(profile.phase_ns, 0, sizeof(profile.phase_ns));
+    memset(profile.counters, 0, sizeof(profile.counters));
+}
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_COUNT(counter, n) ((void)0)
+#define profile_flush_counters() ((void)0)
+#define PROFILE_TURN_START() ((void)0)
+#define profile_report() ((void)0)
+#endif
+
+// ==========================
+// === BITBOARDS
+// ==========================
+static inline void bb_set(Bitboard* b, int x, int y) {
+    int i = TILE_BIT(x, y);
+    b->w[i >> 6] |= 1ULL << (i & 63);
+}
+
+// Décalage vers les index croissants (n > 0) ou décroissants (n < 0), |n| < 64
+static inline Bitboard bb_shift(const Bitboard* b, int n) {
+    Bitboard r;
+    if (n > 0) {
+        r.w[0] = b->w[0] << n;
+        for (int i = 1; i < BB_WORDS; i++) r.w[i] = (b->w[i] << n) | (b->w[i - 1] >> (64 - n));
+    } else {
+        n = -n;
+        for (int i = 0; i < BB_WORDS - 1; i++) r.w[i] = (b->w[i] >> n) | (b->w[i + 1] << (64 - n));
+        r.w[BB_WORDS - 1] = b->w[BB_WORDS - 1] >> n;
+    }
+    return r;
+}
+
+// Voisins 4-connexes de b restreints à mask (le masque colonne empêche le passage d'une ligne à l'autre)
+static Bitboard bb_not_first_col, bb_not_last_col;
+
+static inline Bitboard bb_neighbors(const Bitboard* b, const Bitboard* mask) {
+    Bitboard e = bb_shift(b, 1), w = bb_shift(b, -1), s = bb_shift(b, MAX_WIDTH), n = bb_shift(b, -MAX_WIDTH);
+    Bitboard r;
+    for (int i = 0; i < BB_WORDS; i++)
+        r.w[i] = ((e.w[i] & bb_not_first_col.w[i]) | (w.w[i] & bb_not_last_col.w[i]) | s.w[i] | n.w[i]) & mask->w[i];
+    return r;
+}
+
 void debug_stats() {
     fprintf(stderr, "\n=== STATS ===\n");
 
@@ -155,49 +575,119 @@ void debug_stats() {
     }
 
     // Simulations
-    fprintf(stderr, "Simulations: %d\n", game.output.simulation_count);
+    fprintf(stderr, "Simulations: %d matchups: %d enemy columns: %d\n",
+            game.output.simulation_count, game.output.matchup_count, game.output.matrix_columns);
+#ifdef MCTS
+    fprintf(stderr, "MCTS iterations: %d nodes: %d\n", mcts.iterations, mcts.node_count);
+#else
+    fprintf(stderr, "Search depth: %d nodes: %d tt hits: %d\n",
+            search.depth, search.node_count, search.tt_hits);
+#endif
+    fprintf(stderr, "Schedule: combos %d matchups %d regret iterations %d\n",
+            schedule.combo_budget, schedule.matchup_budget, schedule.regret_iterations);
     fprintf(stderr, "=============\n");
 }
 
 
-int controlled_score_gain_if_agent_moves_to(int agent_id, int nx, int ny) {
-    // Calcule le gain net de zone contrôlée si l'agent se déplace en (nx, ny)
-    int my_gain = 0;
-    int enemy_gain = 0;
+// Noyau AVX2 : une ligne de la carte = 32 distances int8, un masque de bits pour les obstacles
+static inline __m256i control_distance_row(const AgentState* agent, int y) {
+    const __m256i iota = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                          16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    __m256i d = _mm256_add_epi8(_mm256_abs_epi8(_mm256_sub_epi8(iota, _mm256_set1_epi8((char)agent->x))),
+                                _mm256_set1_epi8((char)abs(y - agent->y)));
+    if (agent->wetness >= 50) d = _mm256_add_epi8(d, d);
+    return d;
+}
 
-    for (int y = 0; y < game.consts.map.height; y++) {
-        for (int x = 0; x < game.consts.map.width; x++) {
-            if (game.consts.map.map[y][x].type > 0) continue; // obstacle
-
-            int d_my = INT_MAX;
-            int d_en = INT_MAX;
-
-            for (int i = game.consts.player_info[game.consts.my_player_id].agent_start_index;
-                 i <= game.consts.player_info[game.consts.my_player_id].agent_stop_index; i++) {
-                if (!game.state.agents[i].alive) continue;
-                int ax = (i == agent_id) ? nx : game.state.agents[i].x;
-                int ay = (i == agent_id) ? ny : game.state.agents[i].y;
-                int d = abs(x - ax) + abs(y - ay);
-                if (game.state.agents[i].wetness >= 50) d *= 2;
-                if (d < d_my) d_my = d;
-            }
+static inline int control_row_score(__m256i d_my, __m256i d_en, unsigned int walkable) {
+    unsigned int win  = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(d_en, d_my)) & walkable;
+    unsigned int lose = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(d_my, d_en)) & walkable;
+    return __builtin_popcount(win) - __builtin_popcount(lose);
+}
 
-            for (int i = game.consts.player_info[!game.consts.my_player_id].agent_start_index;
-                 i <= game.consts.player_info[!game.consts.my_player_id].agent_stop_index; i++) {
-                if (!game.state.agents[i].alive) continue;
-                int ax = game.state.agents[i].x;
-                int ay = game.state.agents[i].y;
-                int d = abs(x - ax) + abs(y - ay);
-                if (game.state.agents[i].wetness >= 50) d *= 2;
-                if (d < d_en) d_en = d;
-            }
+void precompute_control_map() {
+    PROFILE_SCOPE(PHASE_CONTROL_MAP);
+    // Lignes de distances min allié/ennemi pour l'état courant, puis lignes sensibles par allié :
+    // celles où un pas de l'agent peut changer le propriétaire d'une tuile
+    ControlMap* cm = &game.output.control;
+    int my_id = game.consts.my_player_id;
+    int height = game.consts.map.height;
+    const __m256i far = _mm256_set1_epi8(CONTROL_FAR);
+
+    for (int y = 0; y < height; y++) {
+        cm->enemy_rows[y] = far;
+        cm->ally_rows[y] = far;
+    }
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        AgentState* agent = &game.state.agents[i];
+        if (!agent->alive) continue;
+        bool mine = game.consts.agent_info[i].player_id == my_id;
+        for (int y = 0; y < height; y++) {
+            __m256i d = control_distance_row(agent, y);
+            if (mine) cm->ally_rows[y] = _mm256_min_epi8(cm->ally_rows[y], d);
+            else      cm->enemy_rows[y] = _mm256_min_epi8(cm->enemy_rows[y], d);
+        }
+    }
 
-            if (d_my < d_en) my_gain++;
-            else if (d_en < d_my) enemy_gain++;
+    cm->base_score = 0;
+    for (int y = 0; y < height; y++) {
+        cm->row_scores[y] = control_row_score(cm->ally_rows[y], cm->enemy_rows[y], game.consts.map.walkable_rows[y]);
+        cm->base_score += cm->row_scores[y];
+    }
+
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        cm->sensitive_rows[i] = 0;
+        AgentState* agent = &game.state.agents[i];
+        if (!agent->alive || game.consts.agent_info[i].player_id != my_id) continue;
+        const __m256i w = _mm256_set1_epi8(agent->wetness >= 50 ? 2 : 1);
+
+        for (int y = 0; y < height; y++) {
+            __m256i others = far;
+            for (int j = 0; j < MAX_AGENTS; j++) {
+                if (j == i || !game.state.agents[j].alive || game.consts.agent_info[j].player_id != my_id) continue;
+                others = _mm256_min_epi8(others, control_distance_row(&game.state.agents[j], y));
+            }
+            cm->others_rows[i][y] = others;
+
+            // après un pas, d_i est dans [d_i - w, d_i + w]
+            __m256i d_i  = control_distance_row(agent, y);
+            __m256i near = _mm256_sub_epi8(d_i, w);
+            __m256i lo   = _mm256_min_epi8(others, near);
+            __m256i hi   = _mm256_min_epi8(others, _mm256_add_epi8(d_i, w));
+            __m256i out  = _mm256_or_si256(_mm256_cmpgt_epi8(lo, cm->enemy_rows[y]),
+                                           _mm256_cmpgt_epi8(cm->enemy_rows[y], hi));
+            unsigned int relevant = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(others, near));
+            unsigned int changing = (unsigned int)~_mm256_movemask_epi8(out);
+            if (relevant & changing & game.consts.map.walkable_rows[y]) cm->sensitive_rows[i] |= 1u << y;
         }
     }
+}
 
-    return my_gain - enemy_gain;
+int controlled_score_gain_if_agent_moves_to(int agent_id, int nx, int ny) {
+    // Score de zone contrôlée (mes tuiles - tuiles ennemies) si l'agent se déplace en (nx, ny),
+    // calculé comme delta sur les lignes de la carte de contrôle du tour
+    PROFILE_COUNT(COUNTER_CONTROL_SCORES, 1);
+    ControlMap* cm = &game.output.control;
+    AgentState* agent = &game.state.agents[agent_id];
+    if (!agent->alive || game.consts.agent_info[agent_id].player_id != game.consts.my_player_id)
+        return cm->base_score;
+
+    int step = abs(nx - agent->x) + abs(ny - agent->y);
+    if (step == 0) return cm->base_score;
+
+    // Un seul pas : seules les lignes sensibles peuvent changer
+    unsigned int rows = (step == 1) ? cm->sensitive_rows[agent_id] : (1u << game.consts.map.height) - 1;
+    AgentState moved = *agent;
+    moved.x = nx;
+    moved.y = ny;
+
+    int delta = 0;
+    for (; rows; rows = _blsr_u32(rows)) {
+        int y = __builtin_ctz(rows);
+        __m256i d_my = _mm256_min_epi8(cm->others_rows[agent_id][y], control_distance_row(&moved, y));
+        delta += control_row_score(d_my, cm->enemy_rows[y], game.consts.map.walkable_rows[y]) - cm->row_scores[y];
+    }
+    return cm->base_score + delta;
 }
 
 
@@ -205,24 +695,89 @@ int controlled_score_gain_if_agent_moves_to(int agent_id, int nx, int ny) {
 // === MAIN FUNCTIONS
 // ==========================
 
-void read_game_inputs_init() {
-    int my_id, agent_info_count;
-    scanf("%d", &my_id);
-    scanf("%d", &agent_info_count);
+// Wetness infligée par un tir : [tireur][case du tireur][case de la cible][cible en hunker],
+// cases en TILE_BIT ; la carte et les stats des agents étant fixes, calculée une fois à l'init
+static uint8_t shot_damage_table[MAX_AGENTS][MAX_HEIGHT * MAX_WIDTH][MAX_HEIGHT * MAX_WIDTH][2];
+
+static float shot_cover(int sx, int sy, int tx, int ty) {
+    // Meilleure couverture adjacente à la cible, entre elle et le tireur ; ignorée si le tireur la touche
+    static const int dirs[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    float protection = 0.0f;
+    for (int d = 0; d < 4; d++) {
+        int cx = tx + dirs[d][0], cy = ty + dirs[d][1];
+        if (cx < 0 || cx >= game.consts.map.width || cy < 0 || cy >= game.consts.map.height) continue;
+        int tile = game.consts.map.map[cy][cx].type;
+        if (tile == 0) continue;
+        if (dirs[d][0] * (sx - cx) + dirs[d][1] * (sy - cy) <= 0) continue;
+        if (abs(sx - cx) <= 1 && abs(sy - cy) <= 1) continue;
+        float cover = tile == 1 ? 0.5f : 0.75f;
+        if (cover > protection) protection = cover;
+    }
+    return protection;
+}
 
-    *(int*)&game.consts.my_player_id = my_id;
-    *(int*)&game.consts.agent_info_count = agent_info_count;
+static void setup_shot_damage_table() {
+    memset(shot_damage_table, 0, sizeof(shot_damage_table));
+    int width = game.consts.map.width, height = game.consts.map.height;
+    for (int a = 0; a < game.consts.agent_info_count; a++) {
+        const AgentInfo* info = &game.consts.agent_info[a];
+        for (int sy = 0; sy < height; sy++)
+        for (int sx = 0; sx < width; sx++)
+        for (int ty = 0; ty < height; ty++)
+        for (int tx = 0; tx < width; tx++) {
+            int dist = abs(sx - tx) + abs(sy - ty);
+            if (dist > 2 * info->optimal_range) continue;
+            float range_modifier = dist <= info->optimal_range ? 1.0f : 0.5f;
+            float protection = shot_cover(sx, sy, tx, ty);
+            uint8_t* entry = shot_damage_table[a][TILE_BIT(sx, sy)][TILE_BIT(tx, ty)];
+            entry[0] = (uint8_t)(info->soaking_power * range_modifier * (1.0f - protection));
+            if (protection + 0.25f < 1.0f)
+                entry[1] = (uint8_t)(info->soaking_power * range_modifier * (1.0f - (protection + 0.25f)));
+        }
+    }
+}
 
-    for (int i = 0; i < agent_info_count; i++) {
-        scanf("%d%d%d%d%d%d",
-              &game.consts.agent_info[i].id,
-              &game.consts.agent_info[i].player_id,
-              &game.consts.agent_info[i].shoot_cooldown,
-              &game.consts.agent_info[i].optimal_range,
-              &game.consts.agent_info[i].soaking_power,
-              &game.consts.agent_info[i].splash_bombs);
+// Distances de plus court chemin sur les tuiles libres : [TILE_BIT départ][TILE_BIT arrivée],
+// DIST_UNREACHABLE hors d'atteinte ; la carte étant fixe, calculées une fois à l'init
+#define DIST_UNREACHABLE 255
+static uint8_t tile_distances[MAX_HEIGHT * MAX_WIDTH][MAX_HEIGHT * MAX_WIDTH];
+
+static inline const uint8_t* agent_distances(const AgentState* agent) {
+    return tile_distances[TILE_BIT(agent->x, agent->y)];
+}
+
+static void setup_tile_distances() {
+    // BFS bit-parallèle depuis chaque tuile libre : chaque couche = voisins de la couche
+    // précédente non encore visités
+    memset(tile_distances, DIST_UNREACHABLE, sizeof(tile_distances));
+    for (int sy = 0; sy < game.consts.map.height; sy++) {
+        for (int sx = 0; sx < game.consts.map.width; sx++) {
+            if (game.consts.map.map[sy][sx].type != 0) continue;
+            uint8_t* dist = tile_distances[TILE_BIT(sx, sy)];
+
+            Bitboard frontier = {0};
+            bb_set(&frontier, sx, sy);
+            Bitboard visited = frontier;
+            for (int d = 0; ; d++) {
+                uint64_t any = 0;
+                for (int i = 0; i < BB_WORDS; i++) {
+                    any |= frontier.w[i];
+                    for (uint64_t bits = frontier.w[i]; bits; bits = _blsr_u64(bits))
+                        dist[i * 64 + __builtin_ctzll(bits)] = d < DIST_UNREACHABLE ? d : DIST_UNREACHABLE - 1;
+                }
+                if (!any) break;
+
+                Bitboard unvisited;
+                for (int i = 0; i < BB_WORDS; i++) unvisited.w[i] = game.consts.map.walkable.w[i] & ~visited.w[i];
+                frontier = bb_neighbors(&frontier, &unvisited);
+                for (int i = 0; i < BB_WORDS; i++) visited.w[i] |= frontier.w[i];
+            }
+        }
     }
+}
 
+void setup_game_constants() {
+    // Données dérivées de l'init (infos par joueur, bitboards), une fois les entrées brutes lues
     // Initialiser les infos par joueur
     for (int p = 0; p < MAX_PLAYERS; ++p) {
         game.consts.player_info[p].agent_count = 0;
@@ -242,91 +797,534 @@ void read_game_inputs_init() {
     }
     fprintf(stderr,"%d %d %d\n",game.consts.player_info[0].agent_count,game.consts.player_info[0].agent_start_index,game.consts.player_info[0].agent_stop_index);
     fprintf(stderr,"%d %d %d\n",game.consts.player_info[1].agent_count,game.consts.player_info[1].agent_start_index,game.consts.player_info[1].agent_stop_index);
-    scanf("%d%d", &game.consts.map.width, &game.consts.map.height);
+    for (int y = 0; y < MAX_HEIGHT; y++) {
+        for (int x = 0; x < MAX_WIDTH; x++) {
+            if (x != 0) bb_set(&bb_not_first_col, x, y);
+            if (x != MAX_WIDTH - 1) bb_set(&bb_not_last_col, x, y);
+        }
+    }
+
+    memset(game.consts.map.walkable_rows, 0, sizeof(game.consts.map.walkable_rows));
+    game.consts.map.walkable = (Bitboard){0};
+    for (int y = 0; y < game.consts.map.height; y++) {
+        for (int x = 0; x < game.consts.map.width; x++) {
+            if (game.consts.map.map[y][x].type != 0) continue;
+            game.consts.map.walkable_rows[y] |= 1u << x;
+            bb_set(&game.consts.map.walkable, x, y);
+        }
+    }
+    setup_shot_damage_table();
+    setup_tile_distances();
+    memset(warm, 0, sizeof(warm)); // nouvelle partie : pas de plan précédent
+    schedule_reset();
+}
+
+bool params_load(Params* out, const char* path) {
+    // Une ligne "nom valeur" par paramètre, les paramètres absents gardent leur valeur
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    char name[64];
+    float value;
+    while (fscanf(file, "%63s %f", name, &value) == 2) {
+        int i = 0;
+        while (i < PARAM_COUNT && strcmp(name, param_names[i]) != 0) i++;
+        if (i == PARAM_COUNT) fprintf(stderr, "unknown parameter %s\n", name);
+        else ((float*)out)[i] = value;
+    }
+    fclose(file);
+    return true;
+}
+
+void params_save(const Params* in, FILE* file) {
+    for (int i = 0; i < PARAM_COUNT; i++) fprintf(file, "%s %.6g\n", param_names[i], ((const float*)in)[i]);
+}
+
+// ==========================
+// === GAME RECORDS
+// ==========================
+// Enregistrement binaire compact d'une partie : en-tête, infos agents et carte une seule fois,
+// puis un bloc par tour. Activé si la variable d'environnement RECORD_DIR est définie
+// (RECORD_SEED optionnel, l'arbitre ne transmet pas la graine au bot).
+#define RECORD_MAGIC 0x31524353u // "SCR1"
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint64_t seed;
+    uint8_t my_player_id;
+    uint8_t agent_info_count;
+    uint8_t width, height;   // suivi de agent_info_count RecordAgentInfo puis width * height types de tuile
+} RecordHeader;
+typedef struct {
+    uint8_t id, player_id, shoot_cooldown, optimal_range, soaking_power, splash_bombs;
+} RecordAgentInfo;
+typedef struct {
+    uint8_t agent_count, my_agent_count; // suivi de agent_count RecordAgentState
+} RecordTurnHeader;
+typedef struct {
+    uint8_t id, x, y, cooldown, splash_bombs, wetness; // id tel que lu (démarre à 1)
+} RecordAgentState;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+} RecordReader;
+
+static FILE* record_output = NULL;
+
+void record_write_init() {
+    const char* dir = getenv("RECORD_DIR");
+    if (!dir) return;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%ld_%d.scr", dir, (long)time(NULL), (int)getpid());
+    record_output = fopen(path, "wb");
+    if (!record_output) return;
+
+    const char* seed = getenv("RECORD_SEED");
+    RecordHeader header = {
+        .magic = RECORD_MAGIC,
+        .seed = seed ? strtoull(seed, NULL, 10) : 0,
+        .my_player_id = game.consts.my_player_id,
+        .agent_info_count = game.consts.agent_info_count,
+        .width = game.consts.map.width,
+        .height = game.consts.map.height
+    };
+    fwrite(&header, sizeof(header), 1, record_output);
+    for (int i = 0; i < game.consts.agent_info_count; i++) {
+        AgentInfo* info = &game.consts.agent_info[i];
+        RecordAgentInfo rec = {info->id, info->player_id, info->shoot_cooldown,
+                               info->optimal_range, info->soaking_power, info->splash_bombs};
+        fwrite(&rec, sizeof(rec), 1, record_output);
+    }
+    for (int y = 0; y < game.consts.map.height; y++)
+        for (int x = 0; x < game.consts.map.width; x++)
+            fputc(game.consts.map.map[y][x].type, record_output);
+    fflush(record_output);
+}
+
+void record_write_turn() {
+    if (!record_output) return;
+    RecordTurnHeader turn = {game.state.agent_count_do_not_use, game.state.my_agent_count_do_not_use};
+    fwrite(&turn, sizeof(turn), 1, record_output);
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        AgentState* agent = &game.state.agents[i];
+        if (!agent->alive) continue;
+        RecordAgentState rec = {agent->id + 1, agent->x, agent->y, agent->cooldown, agent->splash_bombs, agent->wetness};
+        fwrite(&rec, sizeof(rec), 1, record_output);
+    }
+    fflush(record_output);
+}
+
+bool record_open(RecordReader* reader, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RecordHeader)) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    *reader = (RecordReader){data, st.st_size, 0};
+    return true;
+}
+
+void record_close(RecordReader* reader) {
+    munmap((void*)reader->data, reader->size);
+    reader->data = NULL;
+}
+
+static bool record_reject(const char* what) {
+    // Enregistrement tronqué ou corrompu : rien n'est lu au-delà des limites fixes du jeu
+    fprintf(stderr, "RECORD invalid %s\n", what);
+    return false;
+}
+
+bool record_read_init(RecordReader* reader) {
+    // Équivalent de read_game_inputs_init() depuis un enregistrement
+    const RecordHeader* header = (const RecordHeader*)reader->data;
+    if (header->magic != RECORD_MAGIC) return record_reject("magic");
+    if (header->my_player_id >= MAX_PLAYERS) return record_reject("player id");
+    if (header->agent_info_count < 1 || header->agent_info_count > MAX_AGENTS) return record_reject("agent count");
+    if (header->width < 1 || header->width > MAX_WIDTH || header->height < 1 || header->height > MAX_HEIGHT)
+        return record_reject("map size");
+    size_t needed = sizeof(RecordHeader) + header->agent_info_count * sizeof(RecordAgentInfo)
+                  + header->width * header->height;
+    if (needed > reader->size) return record_reject("header size");
+    const RecordAgentInfo* infos = (const RecordAgentInfo*)(reader->data + sizeof(RecordHeader));
+    for (int i = 0; i < header->agent_info_count; i++)
+        if (infos[i].id != i + 1 || infos[i].player_id >= MAX_PLAYERS) return record_reject("agent info");
+    const uint8_t* tiles = (const uint8_t*)(infos + header->agent_info_count);
+    for (int t = 0; t < header->width * header->height; t++)
+        if (tiles[t] > 2) return record_reject("tile type");
+
+    memset(&game, 0, sizeof(game));
+    *(int*)&game.consts.my_player_id = header->my_player_id;
+    *(int*)&game.consts.agent_info_count = header->agent_info_count;
+    for (int i = 0; i < header->agent_info_count; i++)
+        game.consts.agent_info[i] = (AgentInfo){infos[i].id, infos[i].player_id, infos[i].shoot_cooldown,
+                                                infos[i].optimal_range, infos[i].soaking_power, infos[i].splash_bombs};
+
+    game.consts.map.width = header->width;
+    game.consts.map.height = header->height;
+    for (int y = 0; y < header->height; y++)
+        for (int x = 0; x < header->width; x++)
+            game.consts.map.map[y][x] = (Tile){x, y, tiles[y * header->width + x]};
+
+    reader->offset = needed;
+    setup_game_constants();
+    return true;
+}
+
+bool record_read_turn(RecordReader* reader) {
+    // Équivalent de read_game_inputs_cycle() depuis un enregistrement
+    if (reader->offset == reader->size) return false; // fin de partie
+    if (reader->offset + sizeof(RecordTurnHeader) > reader->size) return record_reject("turn header");
+    const RecordTurnHeader* turn = (const RecordTurnHeader*)(reader->data + reader->offset);
+    if (turn->agent_count > game.consts.agent_info_count || turn->my_agent_count > turn->agent_count)
+        return record_reject("turn agent count");
+    size_t size = sizeof(RecordTurnHeader) + turn->agent_count * sizeof(RecordAgentState);
+    if (reader->offset + size > reader->size) return record_reject("turn size");
+    const RecordAgentState* agents = (const RecordAgentState*)(turn + 1);
+    for (int i = 0; i < turn->agent_count; i++)
+        if (agents[i].id < 1 || agents[i].id > game.consts.agent_info_count ||
+            agents[i].x >= game.consts.map.width || agents[i].y >= game.consts.map.height)
+            return record_reject("agent state");
+
+    PROFILE_TURN_START();
+    PROFILE_SCOPE(PHASE_READ);
+    for (int i = 0; i < MAX_AGENTS; i++) game.state.agents[i].alive = 0;
+    game.state.agent_count_do_not_use = turn->agent_count;
+    game.state.my_agent_count_do_not_use = turn->my_agent_count;
+    for (int i = 0; i < turn->agent_count; i++) {
+        int agent_id = agents[i].id - 1;
+        game.state.agents[agent_id] = (AgentState){agent_id, agents[i].x, agents[i].y, agents[i].cooldown,
+                                                   agents[i].splash_bombs, agents[i].wetness, 1};
+    }
+    reader->offset += size;
+    TURN_RESET;
+    return true;
+}
+
+// Lecture de stdin par blocs avec read() et entiers parsés à la main, sans scanf
+#define INPUT_BUFFER_SIZE (1 << 16)
+static struct {
+    char data[INPUT_BUFFER_SIZE];
+    int pos, len;
+} input;
+
+static inline int input_byte() {
+    // -1 en fin d'entrée
+    if (input.pos == input.len) {
+        ssize_t n;
+        do n = read(STDIN_FILENO, input.data, INPUT_BUFFER_SIZE); while (n < 0 && errno == EINTR);
+        if (n <= 0) return -1;
+        input.pos = 0;
+        input.len = (int)n;
+    }
+    return (unsigned char)input.data[input.pos++];
+}
+
+static bool read_int(int* out) {
+    int c = input_byte();
+    while (c != '-' && (c < '0' || c > '9')) {
+        if (c < 0) return false;
+        c = input_byte();
+    }
+    bool negative = c == '-';
+    if (negative) c = input_byte();
+    int value = 0;
+    while (c >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        c = input_byte();
+    }
+    *out = negative ? -value : value;
+    return true;
+}
+
+static int read_int_or_die() {
+    int value;
+    if (!read_int(&value)) ERROR("unexpected end of input");
+    return value;
+}
+
+void read_game_inputs_init() {
+    int my_id = read_int_or_die();
+    int agent_info_count = read_int_or_die();
+
+    *(int*)&game.consts.my_player_id = my_id;
+    *(int*)&game.consts.agent_info_count = agent_info_count;
+
+    for (int i = 0; i < agent_info_count; i++) {
+        AgentInfo* info = &game.consts.agent_info[i];
+        info->id = read_int_or_die();
+        info->player_id = read_int_or_die();
+        info->shoot_cooldown = read_int_or_die();
+        info->optimal_range = read_int_or_die();
+        info->soaking_power = read_int_or_die();
+        info->splash_bombs = read_int_or_die();
+    }
+
+    game.consts.map.width = read_int_or_die();
+    game.consts.map.height = read_int_or_die();
     for (int i = 0; i < game.consts.map.height * game.consts.map.width; i++) {
-        int x, y, tile_type;
-        scanf("%d%d%d", &x, &y, &tile_type);
+        int x = read_int_or_die();
+        int y = read_int_or_die();
+        int tile_type = read_int_or_die();
         game.consts.map.map[y][x] = (Tile){x, y, tile_type};
     }
+
+    setup_game_constants();
+    record_write_init();
 }
 
-void read_game_inputs_cycle() {    
+bool read_game_inputs_cycle() {
     // Réinitialiser tous les agents a dead
     for (int i = 0; i < MAX_AGENTS; i++) {
         game.state.agents[i].alive = 0;
     }
-    scanf("%d", &game.state.agent_count_do_not_use);
-    int agent_id,agent_x,agent_y,agent_cooldown,agent_splash_bombs,agent_wetness;
+    if (!read_int(&game.state.agent_count_do_not_use)) return false; // fin de partie
+
+    // Le tour commence à la réception du premier entier, l'attente de l'arbitre n'est pas comptée
+    // mais la lecture du reste de l'entrée l'est
+    TURN_RESET;
+    PROFILE_TURN_START();
+    PROFILE_SCOPE(PHASE_READ);
     for (int i = 0; i < game.state.agent_count_do_not_use; i++) {
-        scanf("%d%d%d%d%d%d",
-              &agent_id,
-              &agent_x,
-              &agent_y,
-              &agent_cooldown,
-              &agent_splash_bombs,
-              &agent_wetness);
+        int agent_id = read_int_or_die();
+        int agent_x = read_int_or_die();
+        int agent_y = read_int_or_die();
+        int agent_cooldown = read_int_or_die();
+        int agent_splash_bombs = read_int_or_die();
+        int agent_wetness = read_int_or_die();
         // index start at 1
         agent_id = agent_id -1;
         game.state.agents[agent_id] = (AgentState){agent_id,agent_x,agent_y,agent_cooldown,agent_splash_bombs,agent_wetness,1};
     }
     
-    scanf("%d", &game.state.my_agent_count_do_not_use);
-    CPU_RESET;
+    game.state.my_agent_count_do_not_use = read_int_or_die();
+    record_write_turn();
+    return true;
 }
 
-void precompute_bfs_distances() {
-    static const int dirs[4][2] = {{0,1},{1,0},{0,-1},{-1,0}};
+void precompute_occupancy() {
+    PROFILE_SCOPE(PHASE_OCCUPANCY);
+    // Somme 3x3 séparable (union de masques) : lignes puis colonnes
+    uint16_t cells[MAX_HEIGHT][MAX_WIDTH] = {0};
+    uint16_t rows[MAX_HEIGHT][MAX_WIDTH];
+    int width = game.consts.map.width, height = game.consts.map.height;
+    for (int i = 0; i < MAX_AGENTS; i++)
+        if (game.state.agents[i].alive) cells[game.state.agents[i].y][game.state.agents[i].x] |= 1u << i;
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            rows[y][x] = cells[y][x] | (x > 0 ? cells[y][x - 1] : 0) | (x + 1 < width ? cells[y][x + 1] : 0);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            game.output.splash_agents[y][x] = rows[y][x] | (y > 0 ? rows[y - 1][x] : 0) | (y + 1 < height ? rows[y + 1][x] : 0);
+}
 
-    for (int k = 0; k < MAX_AGENTS; k++) {
-        AgentState* enemy = &game.state.agents[k];
-        if (!enemy->alive) continue;
 
-        int eid = enemy->id;
-        int visited[MAX_HEIGHT][MAX_WIDTH] = {0};
-        int dist[MAX_HEIGHT][MAX_WIDTH] = {0};
-
-        int queue_x[MAX_WIDTH * MAX_HEIGHT];
-        int queue_y[MAX_WIDTH * MAX_HEIGHT];
-        int front = 0, back = 0;
-
-        visited[enemy->y][enemy->x] = 1;
-        dist[enemy->y][enemy->x] = 0;
-        queue_x[back] = enemy->x;
-        queue_y[back++] = enemy->y;
-
-        while (front < back) {
-            int x = queue_x[front];
-            int y = queue_y[front++];
-            for (int d = 0; d < 4; d++) {
-                int nx = x + dirs[d][0];
-                int ny = y + dirs[d][1];
-                if (nx < 0 || nx >= game.consts.map.width || ny < 0 || ny >= game.consts.map.height)
-                    continue;
-                if (game.consts.map.map[ny][nx].type > 0) continue; // obstacle
-                if (visited[ny][nx]) continue;
-
-                visited[ny][nx] = 1;
-                dist[ny][nx] = dist[y][x] + 1;
-
-                queue_x[back] = nx;
-                queue_y[back++] = ny;
+
+// ==========================
+// === MODÈLE DE TOUR
+// ==========================
+// Règles exactes d'un tour simultané, appliquées en place sur un tableau d'agents : un pas de
+// déplacement avec collisions, hunker, tirs (portée, couverture), bombes, recharge, élimination.
+// Chaque agent est sauvegardé dans le journal avant sa première écriture, turn_unmake() remet
+// l'état d'origine sans recopier le tableau. Partagé par l'évaluation, la recherche et le self-play.
+#define THROW_RANGE 4
+#define SPLASH_DAMAGE 30
+
+typedef struct {
+    uint16_t touched;               // bit a = agent a déjà sauvegardé
+    int count;
+    uint8_t ids[MAX_AGENTS];
+    AgentState saved[MAX_AGENTS];
+} TurnUndo;
+
+static inline void turn_touch(TurnUndo* undo, const AgentState* agents, int a) {
+    if (undo->touched & (1u << a)) return;
+    undo->touched |= 1u << a;
+    undo->ids[undo->count] = a;
+    undo->saved[undo->count++] = agents[a];
+}
+
+static inline bool tile_walkable(int x, int y) {
+    // walkable_rows est à 0 au-delà de la largeur : seul y est à borner
+    return (unsigned)y < (unsigned)game.consts.map.height && (unsigned)x < MAX_WIDTH
+        && (game.consts.map.walkable_rows[y] >> x) & 1;
+}
+
+static __attribute__((noinline)) void turn_step_far(const AgentState* agent, int tx, int ty, int* nx, int* ny) {
+    // Cible non adjacente : premier pas du plus court chemin sur les tuiles libres, voisin le plus
+    // proche de la cible dans tile_distances (symétrique). Une cible occupée par un obstacle est
+    // atteinte par ses voisins libres
+    if (tx < 0 || tx >= game.consts.map.width || ty < 0 || ty >= game.consts.map.height) return;
+
+    static const int dirs[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    const uint8_t* rows[4];
+    int sources = 0;
+    if (tile_walkable(tx, ty)) {
+        rows[sources++] = tile_distances[TILE_BIT(tx, ty)];
+    } else {
+        for (int d = 0; d < 4; d++)
+            if (tile_walkable(tx + dirs[d][0], ty + dirs[d][1]))
+                rows[sources++] = tile_distances[TILE_BIT(tx + dirs[d][0], ty + dirs[d][1])];
+    }
+    int best = DIST_UNREACHABLE;
+    for (int k = 0; k < sources; k++)
+        if (rows[k][TILE_BIT(agent->x, agent->y)] < best) best = rows[k][TILE_BIT(agent->x, agent->y)];
+    for (int d = 0; d < 4; d++) {
+        int vx = agent->x + dirs[d][0], vy = agent->y + dirs[d][1];
+        if (!tile_walkable(vx, vy)) continue;
+        for (int k = 0; k < sources; k++) {
+            if (rows[k][TILE_BIT(vx, vy)] < best) {
+                best = rows[k][TILE_BIT(vx, vy)];
+                *nx = vx;
+                *ny = vy;
             }
         }
+    }
+}
+
+static inline void turn_step(const AgentState* agent, int tx, int ty, int* nx, int* ny) {
+    // Un pas vers la cible ; les commandes du bot visent toujours une case adjacente
+    *nx = agent->x;
+    *ny = agent->y;
+    if (tx == agent->x && ty == agent->y) return;
+    if (abs(tx - agent->x) + abs(ty - agent->y) == 1) {
+        if (tile_walkable(tx, ty)) { *nx = tx; *ny = ty; }
+        return;
+    }
+    turn_step_far(agent, tx, ty, nx, ny);
+}
+
+static inline int turn_shot_damage(int shooter_id, const AgentState* shooter, const AgentState* target, bool hunkered) {
+    // 0 hors portée ; la validité du tir (portée, cooldown, cible) reste à la charge de l'appelant
+    return shot_damage_table[shooter_id][TILE_BIT(shooter->x, shooter->y)][TILE_BIT(target->x, target->y)][hunkered];
+}
 
-        // Stocker dans la sortie
-        for (int y = 0; y < game.consts.map.height; y++) {
-            for (int x = 0; x < game.consts.map.width; x++) {
-                if (!visited[y][x])
-                    game.output.bfs_enemy_distances[eid][y][x] = 9999;
-                else
-                    game.output.bfs_enemy_distances[eid][y][x] = dist[y][x];
+static __attribute__((noinline)) unsigned turn_resolve_collisions(const int* pos, int* dest, unsigned alive, unsigned moving) {
+    // Tous les agents visant une même case restent sur place, de même que deux agents qui
+    // échangent leurs cases ; chaque annulation peut en bloquer d'autres, jusqu'à stabilité
+    for (;;) {
+        unsigned cancel = 0;
+        for (unsigned m = moving; m; m &= m - 1) {
+            int a = __builtin_ctz(m);
+            for (unsigned o = alive & ~(1u << a); o; o &= o - 1) {
+                int b = __builtin_ctz(o);
+                if (dest[b] == dest[a] || (dest[a] == pos[b] && dest[b] == pos[a])) {
+                    cancel |= 1u << a;
+                    break;
+                }
             }
         }
+        if (!cancel) return moving;
+        for (unsigned m = cancel; m; m &= m - 1) {
+            int a = __builtin_ctz(m);
+            dest[a] = pos[a];
+        }
+        moving &= ~cancel;
     }
 }
 
+void turn_make(AgentState* agents, const AgentCommand* const cmds[MAX_AGENTS], TurnUndo* undo) {
+    // Applique un tour complet (commandes de tous les agents, NULL = aucune) sur agents[]
+    PROFILE_COUNT(COUNTER_SIMULATIONS, 1);
+    undo->touched = 0;
+    undo->count = 0;
+
+    // === Étape 1 : déplacements, un pas chacun, annulés en cas de collision jusqu'à stabilité
+    int pos[MAX_AGENTS], dest[MAX_AGENTS];
+    unsigned alive = 0, moving = 0;
+    for (int a = 0; a < MAX_AGENTS; a++) {
+        if (!agents[a].alive) continue;
+        alive |= 1u << a;
+        pos[a] = dest[a] = TILE_BIT(agents[a].x, agents[a].y);
+        if (!cmds[a] || (cmds[a]->mv_x == agents[a].x && cmds[a]->mv_y == agents[a].y)) continue;
+        int nx, ny;
+        turn_step(&agents[a], cmds[a]->mv_x, cmds[a]->mv_y, &nx, &ny);
+        dest[a] = TILE_BIT(nx, ny);
+        if (dest[a] != pos[a]) moving |= 1u << a;
+    }
+    // Cas courant sans conflit : cases d'arrivée toutes distinctes, aucune arrivée sur le départ d'un autre
+    bool conflict = false;
+    if (moving) {
+        uint64_t claimed[BB_WORDS] = {0}, leaving[BB_WORDS] = {0};
+        for (unsigned m = moving; m; m &= m - 1) {
+            int a = __builtin_ctz(m);
+            leaving[pos[a] >> 6] |= 1ULL << (pos[a] & 63);
+        }
+        for (unsigned m = alive; m; m &= m - 1) {
+            int a = __builtin_ctz(m);
+            uint64_t bit = 1ULL << (dest[a] & 63);
+            if ((claimed[dest[a] >> 6] & bit) || ((moving >> a) & 1 && (leaving[dest[a] >> 6] & bit))) conflict = true;
+            claimed[dest[a] >> 6] |= bit;
+        }
+    }
+    if (conflict) moving = turn_resolve_collisions(pos, dest, alive, moving);
+    for (unsigned m = moving; m; m &= m - 1) {
+        int a = __builtin_ctz(m);
+        turn_touch(undo, agents, a);
+        agents[a].x = dest[a] % MAX_WIDTH;
+        agents[a].y = dest[a] / MAX_WIDTH;
+    }
+
+    // === Étape 2 : hunker puis tirs et bombes simultanés, depuis les positions après déplacement
+    unsigned hunkered = 0;
+    for (unsigned m = alive; m; m &= m - 1) {
+        int a = __builtin_ctz(m);
+        if (cmds[a] && cmds[a]->action_type == CMD_HUNKER) hunkered |= 1u << a;
+    }
+
+    int damage[MAX_AGENTS] = {0};
+    unsigned shot = 0;
+    for (unsigned m = alive; m; m &= m - 1) {
+        int a = __builtin_ctz(m);
+        if (!cmds[a]) continue;
+        const AgentCommand* cmd = cmds[a];
+        const AgentInfo* info = &game.consts.agent_info[a];
+        if (cmd->action_type == CMD_SHOOT) {
+            int t = cmd->target_x_or_id;
+            if (agents[a].cooldown > 0 || t < 0 || t >= MAX_AGENTS || !(alive & (1u << t))) continue;
+            if (game.consts.agent_info[t].player_id == info->player_id) continue;
+            if (abs(agents[a].x - agents[t].x) + abs(agents[a].y - agents[t].y) > 2 * info->optimal_range) continue;
+            damage[t] += turn_shot_damage(a, &agents[a], &agents[t], (hunkered >> t) & 1);
+            shot |= 1u << a;
+        } else if (cmd->action_type == CMD_THROW) {
+            int tx = cmd->target_x_or_id, ty = cmd->target_y;
+            if (agents[a].splash_bombs <= 0) continue;
+            if (tx < 0 || tx >= game.consts.map.width || ty < 0 || ty >= game.consts.map.height) continue;
+            if (abs(agents[a].x - tx) + abs(agents[a].y - ty) > THROW_RANGE) continue;
+            turn_touch(undo, agents, a);
+            agents[a].splash_bombs--;
+            for (unsigned o = alive; o; o &= o - 1) {
+                int t = __builtin_ctz(o);
+                if (abs(agents[t].x - tx) <= 1 && abs(agents[t].y - ty) <= 1) damage[t] += SPLASH_DAMAGE;
+            }
+        }
+    }
 
+    // === Étape 3 : recharge, wetness et élimination
+    for (unsigned m = alive; m; m &= m - 1) {
+        int a = __builtin_ctz(m);
+        bool has_shot = shot & (1u << a);
+        if (!has_shot && agents[a].cooldown == 0 && damage[a] == 0) continue;
+        turn_touch(undo, agents, a);
+        if (has_shot) agents[a].cooldown = game.consts.agent_info[a].shoot_cooldown;
+        else if (agents[a].cooldown > 0) agents[a].cooldown--;
+        agents[a].wetness += damage[a];
+        if (agents[a].wetness >= 100) {
+            agents[a].wetness = 100;
+            agents[a].alive = 0;
+        }
+    }
+}
 
+void turn_unmake(AgentState* agents, const TurnUndo* undo) {
+    for (int k = 0; k < undo->count; k++) agents[undo->ids[k]] = undo->saved[k];
+}
 
 void compute_best_agents_moves(int agent_id) {
     static const int dirs[5][2] = {
@@ -359,7 +1357,7 @@ void compute_best_agents_moves(int agent_id) {
         if (enemy->splash_bombs <= 0) continue;
 
         int dist = abs(enemy->x - agent_state->x) + abs(enemy->y - agent_state->y);
-        if (dist <= 7) {
+        if (dist <= params.move_danger_range) {
             danger = true;
             break;
         }
@@ -378,7 +1376,7 @@ void compute_best_agents_moves(int agent_id) {
             AgentState* op_state = &game.state.agents[k];
             if (!op_state->alive) continue;
 
-            int dist = game.output.bfs_enemy_distances[op_state->id][ny][nx];
+            int dist = agent_distances(op_state)[TILE_BIT(nx, ny)];
             if (dist < min_dist_to_enemy) min_dist_to_enemy = dist;
         }
 
@@ -390,14 +1388,14 @@ void compute_best_agents_moves(int agent_id) {
                 if (!ally->alive) continue;
 
                 int dist_ally = abs(ally->x - nx) + abs(ally->y - ny);
-                if (dist_ally < 3) {
-                    penalty += 20.0f;
+                if (dist_ally < params.move_ally_radius) {
+                    penalty += params.move_ally_penalty;
                 }
             }
         }
 
         int gain = controlled_score_gain_if_agent_moves_to(agent_id, nx, ny);
-        float score = (float)gain*10 + (-min_dist_to_enemy - penalty);
+        float score = (float)gain * params.move_control + (-min_dist_to_enemy * params.move_enemy_distance - penalty);
 
         AgentAction action = {
             .target_x_or_id = nx,
@@ -405,20 +1403,7 @@ void compute_best_agents_moves(int agent_id) {
             .score = score
         };
 
-        if (game.output.move_counts[agent_id] < MAX_MOVES_PER_AGENT) {
-            game.output.moves[agent_id][game.output.move_counts[agent_id]++] = action;
-        }
-    }
-
-    // Tri décroissant du score
-    for (int m = 0; m < game.output.move_counts[agent_id] - 1; m++) {
-        for (int n = m + 1; n < game.output.move_counts[agent_id]; n++) {
-            if (game.output.moves[agent_id][n].score > game.output.moves[agent_id][m].score) {
-                AgentAction tmp = game.output.moves[agent_id][m];
-                game.output.moves[agent_id][m] = game.output.moves[agent_id][n];
-                game.output.moves[agent_id][n] = tmp;
-            }
-        }
+        TOPK_PUSH(game.output.moves[agent_id], game.output.move_counts[agent_id], MAX_MOVES_PER_AGENT, action);
     }
 }
 
@@ -454,30 +1439,20 @@ void compute_best_agents_shoot(int agent_id,int new_shooter_x,int new_shooter_y)
 
         // Bonus si proche de la portée optimale
         float optimal_bonus = (dist <= shooter_info->optimal_range)
-            ? 1.5f
+            ? params.shoot_optimal_bonus
             : 1.0f;
 
         // Score = wetness priorité + proximité portée
-        float score = enemy->wetness * optimal_bonus - dist * 2;
+        float score = enemy->wetness * optimal_bonus - dist * params.shoot_distance;
 
         AgentAction shoot = {
             .target_x_or_id = k, // ID de l’ennemi
             .target_y = 0, // unused
             .score = score
         };
-        output_list[shoots_count++] = shoot;
+        TOPK_PUSH(output_list, shoots_count, MAX_SHOOTS_PER_AGENT, shoot);
     }
 
-    // Tri des tirs par score décroissant
-    for (int m = 0; m < shoots_count - 1; m++) {
-        for (int n = m + 1; n < shoots_count; n++) {
-            if (output_list[n].score > output_list[m].score) {
-                AgentAction tmp = output_list[m];
-                output_list[m] = output_list[n];
-                output_list[n] = tmp;
-            }
-        }
-    }
     game.output.shoot_counts[agent_id] = shoots_count;
     
 }
@@ -488,65 +1463,58 @@ void compute_best_agents_bomb(int agent_id,int new_thrower_x,int new_thrower_y)
     AgentInfo* thrower_info   = &game.consts.agent_info[agent_id];
     if (!thrower_state->alive || thrower_state->splash_bombs <= 0) return;
 
-    int my_player_id = thrower_info->player_id;
-    int enemy_player_id = !my_player_id;
-
-    // Parcours des ennemis vivants
-    for (int k = game.consts.player_info[enemy_player_id].agent_start_index;
-            k <= game.consts.player_info[enemy_player_id].agent_stop_index; ++k) {
-
-        AgentState* enemy = &game.state.agents[k];
-        if (!enemy->alive) continue;
-
-        int tx = enemy->x;
-        int ty = enemy->y;
-
-        // Vérifier portée
-        int dist = abs(tx - new_thrower_x) + abs(ty - new_thrower_y);
-        if (dist > 4) continue;
-
-        // Vérifier que la bombe ne touche pas un allié ni le lanceur
-        bool hits_ally_or_self = false;
-        for (int a = game.consts.player_info[my_player_id].agent_start_index;
-                a <= game.consts.player_info[my_player_id].agent_stop_index; ++a) {
-            AgentState* ally = &game.state.agents[a];
-            if (!ally->alive) continue;
-
-            int dxa = abs(ally->x - tx);
-            int dya = abs(ally->y - ty);
-            if (dxa <= 1 && dya <= 1) {
-                hits_ally_or_self = true;
-                break;
+    int enemy_player_id = !thrower_info->player_id;
+    const PlayerAgentInfo* enemies = &game.consts.player_info[enemy_player_id];
+    unsigned enemy_mask = enemies->agent_count ? ((2u << enemies->agent_stop_index) - 1) & ~((1u << enemies->agent_start_index) - 1) : 0;
+    unsigned self_bit = 1u << agent_id;
+
+    // Toutes les cases à portée : agents touchés lus dans splash_agents, le lanceur à sa
+    // nouvelle position ; une seule case par ensemble d'agents touchés, la plus centrée
+    unsigned hit_sets[(2 * THROW_RANGE + 1) * (2 * THROW_RANGE + 1)];
+    AgentAction targets[(2 * THROW_RANGE + 1) * (2 * THROW_RANGE + 1)];
+    int spreads[(2 * THROW_RANGE + 1) * (2 * THROW_RANGE + 1)];
+    int target_count = 0;
+    int y_min = new_thrower_y - THROW_RANGE < 0 ? 0 : new_thrower_y - THROW_RANGE;
+    int y_max = new_thrower_y + THROW_RANGE >= game.consts.map.height ? game.consts.map.height - 1 : new_thrower_y + THROW_RANGE;
+    for (int ty = y_min; ty <= y_max; ty++) {
+        int reach = THROW_RANGE - abs(ty - new_thrower_y);
+        int x_min = new_thrower_x - reach < 0 ? 0 : new_thrower_x - reach;
+        int x_max = new_thrower_x + reach >= game.consts.map.width ? game.consts.map.width - 1 : new_thrower_x + reach;
+        for (int tx = x_min; tx <= x_max; tx++) {
+            unsigned hits = game.output.splash_agents[ty][tx] & ~self_bit;
+            if (abs(tx - new_thrower_x) <= 1 && abs(ty - new_thrower_y) <= 1) hits |= self_bit;
+            int enemy_hits = __builtin_popcount(hits & enemy_mask);
+            int ally_hits = __builtin_popcount(hits & ~enemy_mask);
+            if (enemy_hits <= ally_hits) continue;
+
+            int spread = 0;
+            float wetness = 0.0f;
+            for (unsigned m = hits & enemy_mask; m; m &= m - 1) {
+                const AgentState* enemy = &game.state.agents[__builtin_ctz(m)];
+                spread += abs(enemy->x - tx) + abs(enemy->y - ty);
+                wetness += enemy->wetness;
             }
-        }
-
-        if (hits_ally_or_self) continue;
-
-        if (game.output.bomb_counts[agent_id] < MAX_BOMB_PER_AGENT) {
-            game.output.bombs[agent_id][game.output.bomb_counts[agent_id]++] = (AgentAction){
+            int t = 0;
+            while (t < target_count && hit_sets[t] != hits) t++;
+            if (t < target_count && spreads[t] <= spread) continue;
+            if (t == target_count) target_count++;
+            hit_sets[t] = hits;
+            spreads[t] = spread;
+            targets[t] = (AgentAction){
                 .target_x_or_id = tx,
                 .target_y = ty,
-                .score = 100 - enemy->wetness
+                .score = params.bomb_base * (enemy_hits - ally_hits) - wetness
             };
         }
     }
-
-    // Tri décroissant par score
-    int count = game.output.bomb_counts[agent_id];
-    for (int m = 0; m < count - 1; m++) {
-        for (int n = m + 1; n < count; n++) {
-            if (game.output.bombs[agent_id][n].score > game.output.bombs[agent_id][m].score) {
-                AgentAction tmp = game.output.bombs[agent_id][m];
-                game.output.bombs[agent_id][m] = game.output.bombs[agent_id][n];
-                game.output.bombs[agent_id][n] = tmp;
-            }
-        }
-    }
+    for (int t = 0; t < target_count; t++)
+        TOPK_PUSH(game.output.bombs[agent_id], game.output.bomb_counts[agent_id], MAX_BOMB_PER_AGENT, targets[t]);
 }
 
 
 
 void compute_best_agents_commands() {
+    PROFILE_SCOPE(PHASE_AGENT_COMMANDS);
 
     
 
@@ -611,83 +1579,45 @@ void compute_best_agents_commands() {
         game.output.agent_command_counts[i] = cmd_index;
     }
 }
-void compute_best_player_commands() {
-    for (int p = 0; p < MAX_PLAYERS; p++) {
-        game.output.player_command_count[p] = 0;
-
-        int agent_start_id = game.consts.player_info[p].agent_start_index;
-        int agent_stop_id = game.consts.player_info[p].agent_stop_index;
-        int max_cmds[MAX_AGENTS] = {0};
-        int total = 1;
-
-        // Initialisation avec 1 commande par agent vivant
-        for (int agent_id = agent_start_id; agent_id <= agent_stop_id; agent_id++) {
-            if (!game.state.agents[agent_id].alive) continue;
-            max_cmds[agent_id] = 1;
-        }
-
-        // Répartition intelligente
-        bool updated = true;
-        while (updated) {
-            updated = false;
-            for (int agent_id = agent_start_id; agent_id <= agent_stop_id; agent_id++) {
-                if (!game.state.agents[agent_id].alive) continue;
-
-                int current = max_cmds[agent_id];
-                int available = game.output.agent_command_counts[agent_id];
-
-                if (current < available) {
-                    int new_total = total / current * (current + 1);
-                    if (new_total <= MAX_COMMANDS_PER_PLAYER) {
-                        max_cmds[agent_id]++;
-                        total = new_total;
-                        updated = true;
-                    }
-                }
-            }
-        }
-
-        // Génération du produit cartésien avec les limites fixées
-        int indices[MAX_AGENTS] = {0};
+static inline const AgentCommand* player_command(int player, int combo, int agent_id) {
+    return &game.output.agent_commands[agent_id][game.output.player_commands[player][combo][agent_id]];
+}
 
-        while (true) {
-            if (game.output.player_command_count[p] >= MAX_COMMANDS_PER_PLAYER) ERROR_INT("ERROR to many command",MAX_COMMANDS_PER_PLAYER)
+typedef struct {
+    AgentState sim_agents[MAX_AGENTS];  // copie de travail de game.state.agents, restaurée après chaque simulation
+    int wetness_gain;
+    int nb_50_wet_gain;
+    int nb_100_wet_gain;
+    int control_score;
+} SimulationContext;
 
-            // Construire la combinaison
-            for (int agent_id = agent_start_id; agent_id <= agent_stop_id; agent_id++) {
-                if (!game.state.agents[agent_id].alive) continue;
-                int cmd_id = indices[agent_id];
-                game.output.player_commands[p][game.output.player_command_count[p]][agent_id] =
-                    game.output.agent_commands[agent_id][cmd_id];
-            }
+static inline void simulation_context_init(SimulationContext* ctx) {
+    memcpy(ctx->sim_agents, game.state.agents, sizeof(ctx->sim_agents));
+}
 
-            game.output.player_command_count[p]++;
+static void simulation_account_wetness(SimulationContext* ctx, const AgentState* agents) {
+    // Gain de wetness & morts par rapport à l'état du tour
+    int my_id_player = game.consts.my_player_id;
+    ctx->wetness_gain = 0;
+    ctx->nb_50_wet_gain = 0;
+    ctx->nb_100_wet_gain = 0;
+    for (int aid = 0; aid < MAX_AGENTS; aid++) {
+        int curr = game.state.agents[aid].wetness;
+        int now  = agents[aid].wetness;
+        if (now >= 100) now = 100;
 
-            // Incrémenter les indices
-            int carry = 1;
-            for (int agent_id = agent_start_id; agent_id <= agent_stop_id && carry; agent_id++) {
-                if (!game.state.agents[agent_id].alive) continue;
+        int pid = game.consts.agent_info[aid].player_id;
+        int delta = now - curr;
+        if (delta == 0) continue;
 
-                indices[agent_id]++;
-                if (indices[agent_id] >= max_cmds[agent_id]) {
-                    indices[agent_id] = 0;
-                    carry = 1;
-                } else {
-                    carry = 0;
-                }
-            }
+        if (now >= 100 && curr < 100)
+            ctx->nb_100_wet_gain += (pid == my_id_player) ? -1 : +1;
+        if (now >= 50 && curr < 50)
+            ctx->nb_50_wet_gain += (pid == my_id_player) ? -1 : +1;
 
-            if (carry) break;
-        }
+        ctx->wetness_gain += (pid == my_id_player) ? -delta : +delta;
     }
 }
-typedef struct {
-    AgentState sim_agents[MAX_AGENTS];
-    int wetness_gain;
-    int nb_50_wet_gain;
-    int nb_100_wet_gain;
-    int control_score;
-} SimulationContext;
 
 void simulate_players_commands(int my_cmd_index, int en_cmd_index, SimulationContext* ctx) {
     int my_id = game.consts.my_player_id;
@@ -697,146 +1627,1048 @@ void simulate_players_commands(int my_cmd_index, int en_cmd_index, SimulationCon
     int en_start = game.consts.player_info[en_id].agent_start_index;
     int en_stop  = game.consts.player_info[en_id].agent_stop_index;
 
-    memcpy(ctx->sim_agents, game.state.agents, sizeof(ctx->sim_agents));
-    ctx->wetness_gain = 0;
-    ctx->nb_50_wet_gain = 0;
-    ctx->nb_100_wet_gain = 0;
+    const AgentCommand* cmds[MAX_AGENTS] = {0};
+    for (int aid = my_start; aid <= my_stop; aid++)
+        cmds[aid] = player_command(my_id, my_cmd_index, aid);
+    for (int aid = en_start; aid <= en_stop; aid++)
+        cmds[aid] = player_command(en_id, en_cmd_index, aid);
 
-    // === Étape 1: Appliquer les déplacements pour me + enemy ===
-    for (int aid = 0; aid < MAX_AGENTS; aid++) {
+    TurnUndo undo;
+    turn_make(ctx->sim_agents, cmds, &undo);
+    simulation_account_wetness(ctx, ctx->sim_agents);
+
+    // === Étape 4 : contrôle
+    ctx->control_score = 0;
+    for (int aid = my_start; aid <= my_stop; aid++) {
         if (!ctx->sim_agents[aid].alive) continue;
+        ctx->control_score += controlled_score_gain_if_agent_moves_to(aid, ctx->sim_agents[aid].x, ctx->sim_agents[aid].y);
+    }
+    turn_unmake(ctx->sim_agents, &undo);
+}
 
-        AgentCommand* cmd = NULL;
-        if (aid >= my_start && aid <= my_stop) {
-            cmd = &game.output.player_commands[my_id][my_cmd_index][aid];
-        } else if (aid >= en_start && aid <= en_stop) {
-            cmd = &game.output.player_commands[en_id][en_cmd_index][aid];
-        } else continue;
 
-        ctx->sim_agents[aid].x = cmd->mv_x;
-        ctx->sim_agents[aid].y = cmd->mv_y;
-    }
 
-    // === Étape 2: Appliquer les tirs et bombes pour me + enemy ===
-    for (int aid = 0; aid < MAX_AGENTS; aid++) {
-        if (!ctx->sim_agents[aid].alive) continue;
+float evaluate_simulation(const SimulationContext* ctx) {
+    PROFILE_COUNT(COUNTER_EVALUATIONS, 1);
+    
 
-        AgentCommand* cmd = NULL;
-        if (aid >= my_start && aid <= my_stop) {
-            cmd = &game.output.player_commands[my_id][my_cmd_index][aid];
-        } else if (aid >= en_start && aid <= en_stop) {
-            cmd = &game.output.player_commands[en_id][en_cmd_index][aid];
-        } else continue;
+    return
+        ctx->control_score / 100.0f  * params.eval_control +
+        ctx->wetness_gain / 100.0f   * params.eval_wetness +
+        ctx->nb_50_wet_gain / 10.0f  * params.eval_wet50 +
+        ctx->nb_100_wet_gain / 10.0f * params.eval_wet100;
+}
+// ==========================
+// === DÉMARRAGE À CHAUD
+// ==========================
+// Plan retenu au tour précédent par chaque siège : ma meilleure combinaison et la pire réponse
+// ennemie trouvée contre elle. Prolongé d'un tour (même action, même direction de déplacement),
+// il est ajouté aux commandes candidates, sert de premier point de départ à l'optimiseur des
+// combinaisons puis est placé juste après la combinaison 0 dans l'ordre des matchups.
+static bool warm_shifted_command(const WarmStart* w, int agent_id, AgentCommand* out) {
+    // Commande du plan précédent rejouée depuis la position actuelle de l'agent
+    const AgentState* from = &w->from[agent_id];
+    const AgentState* agent = &game.state.agents[agent_id];
+    const AgentInfo* info = &game.consts.agent_info[agent_id];
+    if (!from->alive || !agent->alive) return false;
+
+    AgentCommand cmd = w->plan[agent_id];
+    int nx = agent->x + cmd.mv_x - from->x;
+    int ny = agent->y + cmd.mv_y - from->y;
+    if (!tile_walkable(nx, ny)) { nx = agent->x; ny = agent->y; }
+    cmd.mv_x = nx;
+    cmd.mv_y = ny;
+
+    bool valid = true;
+    if (cmd.action_type == CMD_SHOOT) {
+        const AgentState* target = &game.state.agents[cmd.target_x_or_id];
+        valid = agent->cooldown == 0 && target->alive
+            && abs(target->x - nx) + abs(target->y - ny) <= 2 * info->optimal_range;
+    } else if (cmd.action_type == CMD_THROW) {
+        valid = agent->splash_bombs > 0
+            && abs(cmd.target_x_or_id - nx) + abs(cmd.target_y - ny) <= THROW_RANGE;
+    }
+    if (!valid) cmd = (AgentCommand){nx, ny, CMD_HUNKER, -1, -1, 0.0f};
+    *out = cmd;
+    return true;
+}
 
-        if (cmd->action_type == CMD_THROW) {
-            for (int t = 0; t < MAX_AGENTS; t++) {
-                if (!ctx->sim_agents[t].alive) continue;
-                int dx = abs(ctx->sim_agents[t].x - cmd->target_x_or_id);
-                int dy = abs(ctx->sim_agents[t].y - cmd->target_y);
-                if (dx <= 1 && dy <= 1)
-                    ctx->sim_agents[t].wetness += 30;
+static void warm_start_seed_commands() {
+    // Ajoute le plan prolongé aux commandes candidates s'il n'y figure pas et note ses index
+    WarmStart* w = &warm[game.consts.my_player_id];
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        w->seeded[p] = w->valid;
+        memset(w->seeds[p], 0, MAX_AGENTS);
+        if (!w->valid) continue;
+        for (int a = game.consts.player_info[p].agent_start_index; a <= game.consts.player_info[p].agent_stop_index; a++) {
+            AgentCommand cmd;
+            if (!warm_shifted_command(w, a, &cmd)) continue;
+            AgentCommand* cmds = game.output.agent_commands[a];
+            int count = game.output.agent_command_counts[a];
+            int k = 0;
+            while (k < count && !(cmds[k].mv_x == cmd.mv_x && cmds[k].mv_y == cmd.mv_y && cmds[k].action_type == cmd.action_type
+                                  && cmds[k].target_x_or_id == cmd.target_x_or_id && cmds[k].target_y == cmd.target_y)) k++;
+            if (k == count) {
+                if (count == MAX_COMMANDS_PER_AGENT) k = 0;
+                else cmds[game.output.agent_command_counts[a]++] = cmd;
             }
-        } else if (cmd->action_type == CMD_SHOOT) {
-            int target_id = cmd->target_x_or_id;
-            if (!ctx->sim_agents[target_id].alive) continue;
-
-            AgentState* shooter = &ctx->sim_agents[aid];
-            AgentState* target  = &ctx->sim_agents[target_id];
-            AgentInfo* shooter_info = &game.consts.agent_info[aid];
-
-            int dx = abs(shooter->x - target->x);
-            int dy = abs(shooter->y - target->y);
-            int dist = dx + dy;
-            float range_modifier = dist <= shooter_info->optimal_range ? 1.0f :
-                                   dist <= 2 * shooter_info->optimal_range ? 0.5f : 0.0f;
-            if (range_modifier == 0.0f) continue;
-
-            float cover_modifier = 1.0f;
-            int adj_x = -((target->x - shooter->x) > 0) + ((target->x - shooter->x) < 0);
-            int adj_y = -((target->y - shooter->y) > 0) + ((target->y - shooter->y) < 0);
-            int cx = target->x + adj_x;
-            int cy = target->y + adj_y;
-            if (cx >= 0 && cx < game.consts.map.width && cy >= 0 && cy < game.consts.map.height) {
-                int tile = game.consts.map.map[cy][cx].type;
-                if (tile == 1) cover_modifier = 0.5f;
-                else if (tile == 2) cover_modifier = 0.25f;
+            w->seeds[p][a] = k;
+        }
+    }
+}
+
+static const uint8_t* warm_start_seed(int player) {
+    const WarmStart* w = &warm[game.consts.my_player_id];
+    return w->seeded[player] ? w->seeds[player] : NULL;
+}
+
+void warm_start_save() {
+    // Plan du tour, relu au prochain appel de plan_turn() par le même siège
+    int my_id = game.consts.my_player_id;
+    WarmStart* w = &warm[my_id];
+    w->valid = game.output.simulation_count > 0;
+    if (!w->valid) return;
+    const SimulationResult* best = &game.output.simulation_results[0];
+    memcpy(w->from, game.state.agents, sizeof(w->from));
+    for (int a = 0; a < game.consts.agent_info_count; a++) {
+        if (!game.state.agents[a].alive) continue;
+        bool mine = game.consts.agent_info[a].player_id == my_id;
+        w->plan[a] = mine ? *player_command(my_id, best->my_cmds_index, a)
+                          : *player_command(!my_id, best->op_cmds_index, a);
+    }
+}
+
+// ==========================
+// === JOINT COMMANDS
+// ==========================
+// Combinaisons de commandes par joueur, trouvées par descente de coordonnées (meilleure réponse
+// agent par agent) avec le modèle de tour. L'ennemi est optimisé contre mes meilleures
+// commandes individuelles, puis je réponds à sa meilleure combinaison. Chaque combinaison
+// visitée est mémorisée avec sa valeur ; la table finale les trie de la meilleure à la pire,
+// la colonne 0 est donc la réponse ennemie la plus probable.
+#define JOINT_RESTARTS 16       // redémarrages depuis la meilleure combinaison, un agent déplacé
+#define JOINT_MAX_PASSES 4      // passes de descente sur tous les agents
+#define JOINT_HASH_BITS 11
+#define JOINT_SCRATCH (MAX_COMMANDS_PER_PLAYER - 1) // case de travail de la table des combinaisons
+
+typedef struct {
+    uint8_t cmds[MAX_AGENTS];
+    float value;                // du point de vue du joueur optimisé
+    int order;                  // ordre de découverte, départage les égalités
+} JointCandidate;
+
+typedef struct {
+    JointCandidate visited[MAX_COMMANDS_PER_PLAYER];
+    int count;
+    double deadline_ms;
+    bool timeout;
+    uint32_t keys[1 << JOINT_HASH_BITS]; // clé + 1, 0 = vide
+    int16_t slots[1 << JOINT_HASH_BITS];
+} JointSearch;
+
+static JointSearch joint;
+
+static float joint_value(int p, const uint8_t* cmds, SimulationContext* ctx) {
+    // Valeur mémorisée d'une combinaison contre la combinaison 0 de l'adversaire
+    int start = game.consts.player_info[p].agent_start_index;
+    int stop = game.consts.player_info[p].agent_stop_index;
+    uint32_t key = 0;
+    for (int a = start; a <= stop; a++) key |= (uint32_t)cmds[a] << (6 * (a - start));
+    uint32_t h = (key * 2654435761u) >> (32 - JOINT_HASH_BITS);
+    while (joint.keys[h]) {
+        if (joint.keys[h] == key + 1) return joint.visited[joint.slots[h]].value;
+        h = (h + 1) & ((1 << JOINT_HASH_BITS) - 1);
+    }
+    if (joint.count >= schedule.combo_budget || joint.timeout) return -FLT_MAX; // budget épuisé
+
+    int my_id = game.consts.my_player_id;
+    memcpy(game.output.player_commands[p][JOINT_SCRATCH], cmds, MAX_AGENTS);
+    if (p == my_id) simulate_players_commands(JOINT_SCRATCH, 0, ctx);
+    else simulate_players_commands(0, JOINT_SCRATCH, ctx);
+    float value = evaluate_simulation(ctx);
+    if (p != my_id) value = -value;
+
+    JointCandidate* candidate = &joint.visited[joint.count];
+    memcpy(candidate->cmds, cmds, MAX_AGENTS);
+    candidate->value = value;
+    candidate->order = joint.count;
+    joint.keys[h] = key + 1;
+    joint.slots[h] = joint.count++;
+    if ((joint.count & 15) == 0 && TURN_MS_USED > joint.deadline_ms) joint.timeout = true;
+    return value;
+}
+
+static void joint_descent(int p, uint8_t* cmds, SimulationContext* ctx) {
+    // Meilleure réponse agent par agent jusqu'à stabilité, cmds reçoit l'optimum local
+    int start = game.consts.player_info[p].agent_start_index;
+    int stop = game.consts.player_info[p].agent_stop_index;
+    float value = joint_value(p, cmds, ctx);
+    bool improved = true;
+    for (int pass = 0; pass < JOINT_MAX_PASSES && improved; pass++) {
+        improved = false;
+        for (int a = start; a <= stop; a++) {
+            if (!game.state.agents[a].alive) continue;
+            int current = cmds[a];
+            int best = current;
+            for (int k = 0; k < game.output.agent_command_counts[a]; k++) {
+                if (k == current) continue;
+                cmds[a] = k;
+                float v = joint_value(p, cmds, ctx);
+                if (v > value) {
+                    value = v;
+                    best = k;
+                }
             }
+            cmds[a] = best;
+            if (best != current) improved = true;
+        }
+    }
+}
+
+static int compare_joint_candidates(const void* a, const void* b) {
+    const JointCandidate* ca = a;
+    const JointCandidate* cb = b;
+    if (ca->value != cb->value) return ca->value < cb->value ? 1 : -1;
+    return ca->order - cb->order;
+}
 
-            float damage = shooter_info->soaking_power * range_modifier * cover_modifier;
-            if (damage > 0) target->wetness += (int)damage;
+static void joint_optimize(int p, SimulationContext* ctx, const uint8_t* seed, double deadline_ms) {
+    // Remplit la table des combinaisons de p, la combinaison 0 adverse étant fixée ; seed (ou NULL)
+    // est le plan prolongé du tour précédent, exploré en premier et rangé en position 1
+    int start = game.consts.player_info[p].agent_start_index;
+    int stop = game.consts.player_info[p].agent_stop_index;
+    int alive[MAX_AGENTS];
+    int alive_count = 0;
+    for (int a = start; a <= stop; a++)
+        if (game.state.agents[a].alive) alive[alive_count++] = a;
+
+    joint.count = 0;
+    joint.deadline_ms = deadline_ms;
+    joint.timeout = false;
+    memset(joint.keys, 0, sizeof(joint.keys));
+
+    // Départs : plan prolongé, puis meilleure commande individuelle de chaque agent (index 0 pour les morts)
+    uint8_t best[MAX_AGENTS] = {0};
+    if (alive_count > 0) {
+        if (seed) {
+            uint8_t cmds[MAX_AGENTS];
+            memcpy(cmds, seed, sizeof(cmds));
+            joint_descent(p, cmds, ctx);
+            joint_descent(p, best, ctx);
+            if (joint_value(p, cmds, ctx) > joint_value(p, best, ctx)) memcpy(best, cmds, sizeof(best));
+        } else {
+            joint_descent(p, best, ctx);
+        }
+        for (int r = 0; r < JOINT_RESTARTS && joint.count < schedule.combo_budget && !joint.timeout; r++) {
+            // Un agent forcé sur une autre commande, puis nouvelle descente
+            int a = alive[r % alive_count];
+            int choices = game.output.agent_command_counts[a];
+            if (choices < 2) continue;
+            uint8_t cmds[MAX_AGENTS];
+            memcpy(cmds, best, sizeof(cmds));
+            cmds[a] = (best[a] + 1 + r / alive_count) % choices;
+            joint_descent(p, cmds, ctx);
+            if (joint_value(p, cmds, ctx) > joint_value(p, best, ctx)) memcpy(best, cmds, sizeof(best));
         }
+    } else {
+        joint_value(p, best, ctx);
     }
 
-    // === Étape 3: Gain de wetness & morts
-    int my_id_player = game.consts.my_player_id;
-    for (int aid = 0; aid < MAX_AGENTS; aid++) {
-        int curr = game.state.agents[aid].wetness;
-        int now  = ctx->sim_agents[aid].wetness;
-        if (now >= 100) {
-            ctx->sim_agents[aid].alive = 0;
-            now = 100;
+    qsort(joint.visited, joint.count, sizeof(JointCandidate), compare_joint_candidates);
+    if (seed) {
+        int c = 1;
+        while (c < joint.count && memcmp(joint.visited[c].cmds, seed, MAX_AGENTS) != 0) c++;
+        if (c < joint.count) {
+            JointCandidate seeded = joint.visited[c];
+            memmove(&joint.visited[2], &joint.visited[1], (c - 1) * sizeof(JointCandidate));
+            joint.visited[1] = seeded;
         }
+    }
+    for (int c = 0; c < joint.count; c++)
+        memcpy(game.output.player_commands[p][c], joint.visited[c].cmds, MAX_AGENTS);
+    game.output.player_command_count[p] = joint.count;
+}
 
-        int pid = game.consts.agent_info[aid].player_id;
-        int delta = now - curr;
-        if (delta == 0) continue;
+void compute_best_player_commands() {
+    PROFILE_SCOPE(PHASE_PLAYER_COMMANDS);
+    int my_id = game.consts.my_player_id;
+    SimulationContext ctx;
+    simulation_context_init(&ctx);
+    warm_start_seed_commands();
 
-        if (now >= 100 && curr < 100)
-            ctx->nb_100_wet_gain += (pid == my_id_player) ? -1 : +1;
-        if (now >= 50 && curr < 50)
-            ctx->nb_50_wet_gain += (pid == my_id_player) ? -1 : +1;
+    // Références : meilleures commandes individuelles des deux joueurs
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        memset(game.output.player_commands[p][0], 0, MAX_AGENTS);
+        game.output.player_command_count[p] = 1;
+    }
+    // L'ennemi dispose de la moitié du temps restant avant l'échéance de la phase
+    double now = TURN_MS_USED;
+    joint_optimize(!my_id, &ctx, warm_start_seed(!my_id), now + (schedule.joint_ms - now) / 2);
+    joint_optimize(my_id, &ctx, warm_start_seed(my_id), schedule.joint_ms);
+}
 
-        ctx->wetness_gain += (pid == my_id_player) ? -delta : +delta;
+#if !EVAL_POOL
+// Les workers du pool comptent leurs matchs localement
+static float evaluate_matchup(SimulationContext* ctx, int my_cmd_index, int en_cmd_index) {
+    simulate_players_commands(my_cmd_index, en_cmd_index, ctx);
+    game.output.matchup_count++;
+    return evaluate_simulation(ctx);
+}
+#endif
+
+#if EVAL_MODE != EVAL_REGRET
+static void matrix_add(int row, int column, float score) {
+    GameOutput* out = &game.output;
+    if (out->row_columns[row] == 0 || score < out->row_worst_values[row]) {
+        out->row_worst_values[row] = score;
+        out->row_worst_columns[row] = column;
     }
+    out->row_sums[row] += score;
+    out->row_columns[row]++;
+}
 
-    // === Étape 4 : contrôle
-    ctx->control_score = 0;
-    for (int aid = my_start; aid <= my_stop; aid++) {
-        if (!ctx->sim_agents[aid].alive) continue;
-        ctx->control_score += controlled_score_gain_if_agent_moves_to(aid, ctx->sim_agents[aid].x, ctx->sim_agents[aid].y);
+static inline float matrix_row_value(int row) {
+#if EVAL_MODE == EVAL_MEAN
+    return game.output.row_sums[row] / game.output.row_columns[row];
+#else
+    return game.output.row_worst_values[row];
+#endif
+}
+
+static void evaluation_collect_results(int best_row, int my_count) {
+    // best_row en tête, puis les EVAL_TOP_K - 1 meilleures autres lignes en un seul passage
+    GameOutput* out = &game.output;
+    out->simulation_count = 1;
+    out->simulation_results[0] = (SimulationResult){
+        .score = matrix_row_value(best_row),
+        .my_cmds_index = best_row,
+        .op_cmds_index = out->row_worst_columns[best_row]
+    };
+    int others = 0;
+    for (int r = 0; r < my_count; r++) {
+        if (r == best_row) continue;
+        SimulationResult result = {
+            .score = matrix_row_value(r),
+            .my_cmds_index = r,
+            .op_cmds_index = out->row_worst_columns[r]
+        };
+        TOPK_PUSH(&out->simulation_results[1], others, EVAL_TOP_K - 1, result);
     }
+    out->simulation_count += others;
 }
 
+static int evaluation_order_rows(int* order, int my_count) {
+    // Meilleures lignes connues d'abord (coupes plus précoces), puis les autres dans l'ordre
+    bool placed[MAX_COMMANDS_PER_PLAYER] = {0};
+    int n = 0;
+    for (int k = 0; k < game.output.simulation_count; k++) {
+        int r = game.output.simulation_results[k].my_cmds_index;
+        order[n++] = r;
+        placed[r] = true;
+    }
+    for (int r = 0; r < my_count; r++)
+        if (!placed[r]) order[n++] = r;
+    return n;
+}
+#endif
 
+#if EVAL_POOL
+// ==========================
+// === THREAD POOL
+// ==========================
+// Un tour de la matrice est découpé en paquets de EVAL_CHUNK_ROWS lignes. Chaque worker prend
+// les paquets de sa plage par le début et vole ceux des autres par la fin. Chaque ligne n'est
+// traitée que par un worker et game.consts / les tables de commandes restent en lecture seule :
+// pas de verrou sur le chemin critique. Le thread principal est le worker 0.
+#define EVAL_CHUNK_ROWS 8
 
-float evaluate_simulation(const SimulationContext* ctx) {
-    
+typedef struct {
+    uint64_t range;                     // paquets restants : début (32 bits bas), fin (32 bits hauts)
+    SimulationResult top[EVAL_TOP_K];   // meilleures lignes complètes du worker
+    int top_count;
+    int matchups;
+} __attribute__((aligned(64))) EvaluationWorker;
 
-    return
-        ctx->control_score / 100.0f  * 10.0f +
-        ctx->wetness_gain / 100.0f   * 100.0f +
-        ctx->nb_50_wet_gain / 10.0f  * 1000.0f +
-        ctx->nb_100_wet_gain / 10.0f * 10000.0f;
+typedef struct {
+    pthread_t threads[THREADS];
+    pthread_barrier_t start, done;
+    EvaluationWorker workers[THREADS];
+    const int* order;
+    int row_count;
+    int columns;
+    double deadline_ms;
+    uint32_t best_bits;   // meilleure valeur (float) des lignes complètes du tour, max atomique
+    bool timeout;
+} EvaluationPool;
+
+static EvaluationPool pool;
+
+static inline float pool_best() {
+    uint32_t bits = __atomic_load_n(&pool.best_bits, __ATOMIC_RELAXED);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void pool_offer_best(float value) {
+    uint32_t old = __atomic_load_n(&pool.best_bits, __ATOMIC_RELAXED);
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (;;) {
+        float current;
+        memcpy(&current, &old, sizeof(current));
+        if (value <= current) return;
+        if (__atomic_compare_exchange_n(&pool.best_bits, &old, bits, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return;
+    }
+}
+
+static int pool_take_chunk(int w) {
+    // Sa propre plage par le début
+    uint64_t* range = &pool.workers[w].range;
+    uint64_t old = __atomic_load_n(range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t begin = (uint32_t)old, end = (uint32_t)(old >> 32);
+        if (begin >= end) break;
+        uint64_t next = ((uint64_t)end << 32) | (begin + 1);
+        if (__atomic_compare_exchange_n(range, &old, next, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return begin;
+    }
+    // Vol par la fin de la plage des autres workers
+    for (int k = 1; k < THREADS; k++) {
+        uint64_t* other = &pool.workers[(w + k) % THREADS].range;
+        old = __atomic_load_n(other, __ATOMIC_ACQUIRE);
+        for (;;) {
+            uint32_t begin = (uint32_t)old, end = (uint32_t)(old >> 32);
+            if (begin >= end) break;
+            uint64_t next = ((uint64_t)(end - 1) << 32) | begin;
+            if (__atomic_compare_exchange_n(other, &old, next, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return end - 1;
+        }
+    }
+    return -1;
+}
+
+static void pool_run_round(int w) {
+    EvaluationWorker* worker = &pool.workers[w];
+    GameOutput* out = &game.output;
+    SimulationContext ctx;
+    simulation_context_init(&ctx);
+    worker->top_count = 0;
+    worker->matchups = 0;
+
+    int chunk;
+    while (!__atomic_load_n(&pool.timeout, __ATOMIC_RELAXED) && (chunk = pool_take_chunk(w)) >= 0) {
+        int stop = (chunk + 1) * EVAL_CHUNK_ROWS;
+        if (stop > pool.row_count) stop = pool.row_count;
+        for (int k = chunk * EVAL_CHUNK_ROWS; k < stop; k++) {
+            int r = pool.order[k];
+            while (out->row_columns[r] < pool.columns) {
+#if EVAL_MODE == EVAL_MAXIMIN
+                // La valeur d'une ligne ne fait que baisser : elle ne battra plus la meilleure
+                if (out->row_columns[r] > 0 && matrix_row_value(r) <= pool_best()) break;
+#endif
+                int c = out->row_columns[r];
+                simulate_players_commands(r, c, &ctx);
+                matrix_add(r, c, evaluate_simulation(&ctx));
+                if ((++worker->matchups & 15) == 0 && TURN_MS_USED > pool.deadline_ms) {
+                    __atomic_store_n(&pool.timeout, true, __ATOMIC_RELAXED);
+                    break;
+                }
+            }
+            if (__atomic_load_n(&pool.timeout, __ATOMIC_RELAXED)) break;
+            if (out->row_columns[r] == pool.columns) {
+                pool_offer_best(matrix_row_value(r));
+                SimulationResult result = {
+                    .score = matrix_row_value(r),
+                    .my_cmds_index = r,
+                    .op_cmds_index = out->row_worst_columns[r]
+                };
+                TOPK_PUSH(worker->top, worker->top_count, EVAL_TOP_K, result);
+            }
+        }
+    }
+    profile_flush_counters();
+}
+
+static void* pool_thread(void* arg) {
+    int w = (int)(intptr_t)arg;
+    for (;;) {
+        pthread_barrier_wait(&pool.start);
+        pool_run_round(w);
+        pthread_barrier_wait(&pool.done);
+    }
+    return NULL;
+}
+
+void evaluation_pool_init() {
+    pthread_barrier_init(&pool.start, NULL, THREADS);
+    pthread_barrier_init(&pool.done, NULL, THREADS);
+    for (int w = 1; w < THREADS; w++)
+        if (pthread_create(&pool.threads[w], NULL, pool_thread, (void*)(intptr_t)w) != 0) ERROR("pthread_create");
+}
+
+static bool pool_round(const int* order, int row_count, int columns, double deadline_ms) {
+    // Un tour de la matrice sur tous les workers ; résultats fusionnés seulement s'il est complet
+    int chunks = (row_count + EVAL_CHUNK_ROWS - 1) / EVAL_CHUNK_ROWS;
+    pool.order = order;
+    pool.row_count = row_count;
+    pool.columns = columns;
+    pool.deadline_ms = deadline_ms;
+    pool.timeout = false;
+    float lowest = -FLT_MAX;
+    memcpy(&pool.best_bits, &lowest, sizeof(lowest));
+    for (int w = 0; w < THREADS; w++) {
+        uint64_t begin = (uint64_t)chunks * w / THREADS, end = (uint64_t)chunks * (w + 1) / THREADS;
+        pool.workers[w].range = (end << 32) | begin;
+    }
+
+    pthread_barrier_wait(&pool.start);
+    pool_run_round(0);
+    pthread_barrier_wait(&pool.done);
+
+    for (int w = 0; w < THREADS; w++) game.output.matchup_count += pool.workers[w].matchups;
+    if (pool.timeout) return false;
+
+    // Fusion des top-K locaux : la tête est la meilleure ligne complète du tour, les lignes
+    // élaguées complètent ensuite la liste comme en mono-thread
+    SimulationResult merged[EVAL_TOP_K];
+    int merged_count = 0;
+    for (int w = 0; w < THREADS; w++)
+        for (int k = 0; k < pool.workers[w].top_count; k++)
+            TOPK_PUSH(merged, merged_count, EVAL_TOP_K, pool.workers[w].top[k]);
+    if (merged_count == 0) return false;
+    evaluation_collect_results(merged[0].my_cmds_index, row_count);
+    return true;
+}
+
+static void compute_evaluation_threaded() {
+    GameOutput* out = &game.output;
+    int my_id = game.consts.my_player_id;
+    int my_count = out->player_command_count[my_id];
+    int en_count = out->player_command_count[!my_id];
+    int order[MAX_COMMANDS_PER_PLAYER];
+
+    out->matchup_count = 0;
+    for (int r = 0; r < my_count; r++) {
+        out->row_columns[r] = 0;
+        out->row_sums[r] = 0.0f;
+        order[r] = r;
+    }
+
+    // Colonne 0 pour toutes les lignes, sans échéance : garantit un résultat
+    pool_round(order, my_count, 1, DBL_MAX);
+    out->matrix_columns = 1;
+
+    for (int columns = 2; out->matrix_columns < en_count && out->matchup_count < schedule.matchup_budget; columns *= 2) {
+        if (columns > en_count) columns = en_count;
+        evaluation_order_rows(order, my_count);
+        if (!pool_round(order, my_count, columns, schedule.evaluation_ms)) break;
+        out->matrix_columns = columns;
+    }
+}
+#endif
+
+#if EVAL_MODE == EVAL_REGRET
+// ==========================
+// === REGRET MATCHING
+// ==========================
+// Équilibre approché du tour simultané sur les REGRET_SIZE premières combinaisons de chaque
+// joueur (tables triées par l'optimiseur), par regret matching+. À chaque itération, une ligne et
+// une colonne sont tirées selon les stratégies courantes ; mes regrets sont mis à jour contre la
+// colonne tirée, ceux de l'ennemi contre la ligne tirée. Chaque itération a donc besoin de toute
+// la colonne tirée et de toute la ligne tirée ; une case n'est simulée qu'une fois, à sa première
+// demande, et les lignes et colonnes jamais tirées restent vides.
+#define REGRET_SIZE 64
+
+typedef struct {
+    float payoff[REGRET_SIZE][REGRET_SIZE];
+    uint64_t filled[REGRET_SIZE];                   // bit c = case (r, c) simulée
+    float regrets[MAX_PLAYERS][REGRET_SIZE];        // [0] mes lignes, [1] colonnes ennemies
+    float strategy_sums[MAX_PLAYERS][REGRET_SIZE];  // stratégies cumulées : la moyenne converge
+    uint64_t sampled_columns;                       // colonnes tirées, donc remplies pour toutes les lignes
+    uint64_t rng;
+    int iterations;                                 // itérations du dernier tour
+} RegretSolver;
+
+static RegretSolver regret;
+
+static inline float regret_payoff(SimulationContext* ctx, int r, int c) {
+    if (!((regret.filled[r] >> c) & 1)) {
+        regret.payoff[r][c] = evaluate_matchup(ctx, r, c);
+        regret.filled[r] |= 1ull << c;
+    }
+    return regret.payoff[r][c];
+}
+
+static void regret_strategy(int side, int count, float* strategy) {
+    // Regrets positifs normalisés, uniforme si aucun
+    float total = 0.0f;
+    for (int i = 0; i < count; i++) total += regret.regrets[side][i];
+    for (int i = 0; i < count; i++)
+        strategy[i] = total > 0.0f ? regret.regrets[side][i] / total : 1.0f / count;
+}
+
+static int regret_sample(const float* strategy, int count) {
+    float u = (float)(random_next(&regret.rng) >> 40) / (float)(1 << 24);
+    for (int i = 0; i < count; i++) {
+        u -= strategy[i];
+        if (u < 0.0f) return i;
+    }
+    return count - 1;
+}
+
+static void compute_evaluation_regret() {
+    GameOutput* out = &game.output;
+    int my_id = game.consts.my_player_id;
+    int rows = out->player_command_count[my_id] < REGRET_SIZE ? out->player_command_count[my_id] : REGRET_SIZE;
+    int columns = out->player_command_count[!my_id] < REGRET_SIZE ? out->player_command_count[!my_id] : REGRET_SIZE;
+    SimulationContext ctx;
+    simulation_context_init(&ctx);
+
+    memset(regret.filled, 0, sizeof(regret.filled));
+    memset(regret.regrets, 0, sizeof(regret.regrets));
+    memset(regret.strategy_sums, 0, sizeof(regret.strategy_sums));
+    regret.sampled_columns = 0;
+    regret.rng = 0x9E3779B97F4A7C15ULL;   // tirages reproductibles
+    out->matchup_count = 0;
+
+    float mine[REGRET_SIZE], theirs[REGRET_SIZE];
+    int iterations = schedule.regret_iterations;
+    if (iterations > REGRET_ITERATIONS_PER_CELL * rows * columns) iterations = REGRET_ITERATIONS_PER_CELL * rows * columns;
+    regret.iterations = 0;
+    while (regret.iterations < iterations) {
+        regret_strategy(0, rows, mine);
+        regret_strategy(1, columns, theirs);
+        for (int r = 0; r < rows; r++) regret.strategy_sums[0][r] += mine[r];
+        for (int c = 0; c < columns; c++) regret.strategy_sums[1][c] += theirs[c];
+
+        int row = regret_sample(mine, rows);
+        int column = regret_sample(theirs, columns);
+        regret.sampled_columns |= 1ull << column;
+        float value = regret_payoff(&ctx, row, column);
+        for (int r = 0; r < rows; r++) {
+            float updated = regret.regrets[0][r] + regret_payoff(&ctx, r, column) - value;
+            regret.regrets[0][r] = updated > 0.0f ? updated : 0.0f;
+        }
+        for (int c = 0; c < columns; c++) {
+            // L'ennemi minimise ma valeur
+            float updated = regret.regrets[1][c] + value - regret_payoff(&ctx, row, c);
+            regret.regrets[1][c] = updated > 0.0f ? updated : 0.0f;
+        }
+        if ((++regret.iterations & 7) == 0) TURN_BREAK(schedule.evaluation_ms);
+    }
+
+    // Valeur de chaque ligne contre la stratégie moyenne ennemie restreinte aux colonnes tirées ;
+    // la ligne la plus jouée par ma stratégie moyenne est le choix retenu
+    float weight = 0.0f;
+    for (int c = 0; c < columns; c++)
+        if ((regret.sampled_columns >> c) & 1) weight += regret.strategy_sums[1][c];
+    int best_row = 0;
+    SimulationResult results[REGRET_SIZE];
+    for (int r = 0; r < rows; r++) {
+        float expected = 0.0f, worst = FLT_MAX;
+        int worst_column = 0;
+        for (int c = 0; c < columns; c++) {
+            if (!((regret.sampled_columns >> c) & 1)) continue;
+            expected += regret.strategy_sums[1][c] * regret.payoff[r][c];
+            if (regret.payoff[r][c] < worst) {
+                worst = regret.payoff[r][c];
+                worst_column = c;
+            }
+        }
+        results[r] = (SimulationResult){expected / weight, r, worst_column};
+        if (regret.strategy_sums[0][r] > regret.strategy_sums[0][best_row]) best_row = r;
+    }
+
+    out->simulation_results[0] = results[best_row];
+    out->simulation_count = 1;
+    int others = 0;
+    for (int r = 0; r < rows; r++)
+        if (r != best_row) TOPK_PUSH(&out->simulation_results[1], others, EVAL_TOP_K - 1, results[r]);
+    out->simulation_count += others;
+    out->matrix_columns = __builtin_popcountll(regret.sampled_columns);
 }
+#endif
+
 void compute_evaluation() {
+    PROFILE_SCOPE(PHASE_EVALUATION);
+#if EVAL_MODE == EVAL_REGRET
+    compute_evaluation_regret();
+#elif EVAL_POOL
+    compute_evaluation_threaded();
+#else
+    // Matrice de gains évaluée par tours successifs : 1, 2, 4... réponses ennemies par ligne
+    // jusqu'à l'échéance. Seul le dernier tour complet compte.
+    GameOutput* out = &game.output;
     int my_id = game.consts.my_player_id;
     int en_id = !my_id;
-    game.output.simulation_count = 0;
+    int my_count = out->player_command_count[my_id];
+    int en_count = out->player_command_count[en_id];
+    int order[MAX_COMMANDS_PER_PLAYER];
+    SimulationContext ctx;
+    simulation_context_init(&ctx);
+
+    out->matchup_count = 0;
+
+    // Colonne 0 pour toutes les lignes : réponse ennemie la plus probable, garantit un résultat
+    int best_row = 0;
+    for (int r = 0; r < my_count; r++) {
+        out->row_columns[r] = 0;
+        out->row_sums[r] = 0.0f;
+        matrix_add(r, 0, evaluate_matchup(&ctx, r, 0));
+        if (matrix_row_value(r) > matrix_row_value(best_row)) best_row = r;
+    }
+    evaluation_collect_results(best_row, my_count);
+    out->matrix_columns = 1;
+
+    bool timeout = false;
+    for (int columns = 2; out->matrix_columns < en_count && out->matchup_count < schedule.matchup_budget; columns *= 2) {
+        if (columns > en_count) columns = en_count;
+        int round_best = -1;
+        float round_value = -FLT_MAX;
+        evaluation_order_rows(order, my_count);
+
+        for (int k = 0; k < my_count && !timeout; k++) {
+            int r = order[k];
+            while (out->row_columns[r] < columns) {
+#if EVAL_MODE == EVAL_MAXIMIN
+                // La valeur d'une ligne ne fait que baisser : elle ne battra plus la meilleure
+                if (round_best >= 0 && matrix_row_value(r) <= round_value) break;
+#endif
+                int c = out->row_columns[r];
+                matrix_add(r, c, evaluate_matchup(&ctx, r, c));
+                if ((out->matchup_count & 15) == 0 && TURN_MS_USED > schedule.evaluation_ms) {
+                    timeout = true;
+                    break;
+                }
+            }
+            if (out->row_columns[r] == columns && matrix_row_value(r) > round_value) {
+                round_value = matrix_row_value(r);
+                round_best = r;
+            }
+        }
+        if (timeout) break;
 
-    int my_count = game.output.player_command_count[my_id];
-    int en_index = 0; // On teste uniquement contre le premier jeu de commandes ennemies
+        out->matrix_columns = columns;
+        evaluation_collect_results(round_best, my_count);
+    }
+#endif
+}
 
-    for (int i = 0; i < my_count; i++) {
-        SimulationContext ctx;
-        simulate_players_commands(i, en_index, &ctx);
-        float score = evaluate_simulation(&ctx);
 
-        game.output.simulation_results[game.output.simulation_count++] = (SimulationResult){
-            .score = score,
-            .my_cmds_index = i,
-            .op_cmds_index = en_index
-        };
+
+
+
+// ==========================
+// === MULTI-TURN SEARCH
+// ==========================
+// Recherche itérative sur plusieurs tours à partir des meilleures lignes de la matrice.
+// Chaque tour simultané est traité en max (mes commandes) puis min (réponses ennemies).
+// Au-delà de la racine, les commandes viennent d'une heuristique gloutonne sur l'état du noeud.
+
+void search_init() {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint64_t* keys[] = {&search.zobrist_position[0][0], &search.zobrist_wetness[0][0],
+                        &search.zobrist_cooldown[0][0], &search.zobrist_bombs[0][0], &search.zobrist_dead[0]};
+    size_t counts[] = {MAX_AGENTS * MAX_HEIGHT * MAX_WIDTH, MAX_AGENTS * 101, MAX_AGENTS * 8, MAX_AGENTS * 8, MAX_AGENTS};
+    for (int k = 0; k < 5; k++) {
+        for (size_t i = 0; i < counts[k]; i++) keys[k][i] = random_next(&seed);
+    }
+}
+
+static uint64_t zobrist_hash(const AgentState* agents) {
+    uint64_t h = 0;
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        const AgentState* a = &agents[i];
+        if (!a->alive) {
+            h ^= search.zobrist_dead[i];
+            continue;
+        }
+        h ^= search.zobrist_position[i][TILE_BIT(a->x, a->y)];
+        h ^= search.zobrist_wetness[i][a->wetness > 100 ? 100 : a->wetness];
+        h ^= search.zobrist_cooldown[i][a->cooldown & 7];
+        h ^= search.zobrist_bombs[i][a->splash_bombs & 7];
+    }
+    return h;
+}
+
+static int control_score_of_agents(const AgentState* agents) {
+    // Score de zone contrôlée d'un état quelconque (noyau AVX2)
+    int my_id = game.consts.my_player_id;
+    int score = 0;
+    for (int y = 0; y < game.consts.map.height; y++) {
+        __m256i d_my = _mm256_set1_epi8(CONTROL_FAR);
+        __m256i d_en = _mm256_set1_epi8(CONTROL_FAR);
+        for (int i = 0; i < MAX_AGENTS; i++) {
+            if (!agents[i].alive) continue;
+            __m256i d = control_distance_row(&agents[i], y);
+            if (game.consts.agent_info[i].player_id == my_id) d_my = _mm256_min_epi8(d_my, d);
+            else d_en = _mm256_min_epi8(d_en, d);
+        }
+        score += control_row_score(d_my, d_en, game.consts.map.walkable_rows[y]);
+    }
+    return score;
+}
+
+static float evaluate_state(const AgentState* agents) {
+    SimulationContext ctx;
+    simulation_account_wetness(&ctx, agents);
+    ctx.control_score = control_score_of_agents(agents);
+    return evaluate_simulation(&ctx);
+}
+
+static void search_greedy_action(const AgentState* agents, int agent_id, int nx, int ny, AgentCommand* cmd) {
+    // Bombe si elle touche au moins 2 ennemis (ou pas de tir possible), sinon tir, sinon hunker
+    const AgentState* self = &agents[agent_id];
+    const AgentInfo* info = &game.consts.agent_info[agent_id];
+    int player = info->player_id;
+    *cmd = (AgentCommand){ .mv_x = nx, .mv_y = ny, .action_type = CMD_HUNKER, .target_x_or_id = -1, .target_y = -1 };
+
+    int best_throw_hits = 0, throw_x = -1, throw_y = -1;
+    if (self->splash_bombs > 0) {
+        for (int k = 0; k < MAX_AGENTS; k++) {
+            const AgentState* enemy = &agents[k];
+            if (!enemy->alive || game.consts.agent_info[k].player_id == player) continue;
+            if (abs(enemy->x - nx) + abs(enemy->y - ny) > THROW_RANGE) continue;
+            int hits = 0;
+            for (int t = 0; t < MAX_AGENTS; t++) {
+                const AgentState* other = &agents[t];
+                if (!other->alive) continue;
+                int tx = (t == agent_id) ? nx : other->x;
+                int ty = (t == agent_id) ? ny : other->y;
+                if (abs(tx - enemy->x) > 1 || abs(ty - enemy->y) > 1) continue;
+                if (game.consts.agent_info[t].player_id == player) { hits = -1; break; }
+                hits++;
+            }
+            if (hits > best_throw_hits) {
+                best_throw_hits = hits;
+                throw_x = enemy->x;
+                throw_y = enemy->y;
+            }
+        }
+    }
+
+    int best_target = -1;
+    float best_damage = 0.0f;
+    if (self->cooldown <= 0) {
+        // Dégâts du modèle de tour (portée et couverture) depuis la case d'arrivée
+        AgentState shooter = *self;
+        shooter.x = nx;
+        shooter.y = ny;
+        for (int k = 0; k < MAX_AGENTS; k++) {
+            const AgentState* enemy = &agents[k];
+            if (!enemy->alive || game.consts.agent_info[k].player_id == player) continue;
+            int shot = turn_shot_damage(agent_id, &shooter, enemy, false);
+            if (shot == 0) continue;
+            float damage = shot + enemy->wetness * 0.01f;
+            if (damage > best_damage) {
+                best_damage = damage;
+                best_target = k;
+            }
+        }
+    }
+
+    if (best_throw_hits >= 2 || (best_throw_hits == 1 && best_target < 0)) {
+        cmd->action_type = CMD_THROW;
+        cmd->target_x_or_id = throw_x;
+        cmd->target_y = throw_y;
+    } else if (best_target >= 0) {
+        cmd->action_type = CMD_SHOOT;
+        cmd->target_x_or_id = best_target;
+        cmd->target_y = 0;
+    }
+}
+
+static int search_generate_commands(const AgentState* agents, int player, AgentCommand out[SEARCH_BRANCH][MAX_AGENTS]) {
+    // Commande 0 : meilleur déplacement de chaque agent, puis une commande par agent
+    // qui prend son second meilleur déplacement
+    static const int dirs[5][2] = {{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    int start = game.consts.player_info[player].agent_start_index;
+    int stop  = game.consts.player_info[player].agent_stop_index;
+    AgentCommand second[MAX_AGENTS];
+    bool has_second[MAX_AGENTS] = {0};
+
+    for (int a = start; a <= stop; a++) {
+        const AgentState* agent = &agents[a];
+        if (!agent->alive) continue;
+        int range = game.consts.agent_info[a].optimal_range;
+        float best_score = -FLT_MAX, second_score = -FLT_MAX;
+        int best_d = 0, second_d = -1;
+
+        for (int d = 0; d < 5; d++) {
+            int nx = agent->x + dirs[d][0];
+            int ny = agent->y + dirs[d][1];
+            if (nx < 0 || nx >= game.consts.map.width || ny < 0 || ny >= game.consts.map.height) continue;
+            if (game.consts.map.map[ny][nx].type > 0) continue;
+
+            // Se placer à portée optimale de l'ennemi le plus proche
+            int nearest = 9999;
+            for (int k = 0; k < MAX_AGENTS; k++) {
+                if (!agents[k].alive || game.consts.agent_info[k].player_id == player) continue;
+                int dist = abs(agents[k].x - nx) + abs(agents[k].y - ny);
+                if (dist < nearest) nearest = dist;
+            }
+            float score = -(float)abs(nearest - range);
+            if (score > best_score) {
+                second_score = best_score; second_d = best_d;
+                best_score = score; best_d = d;
+            } else if (score > second_score) {
+                second_score = score; second_d = d;
+            }
+        }
+
+        search_greedy_action(agents, a, agent->x + dirs[best_d][0], agent->y + dirs[best_d][1], &out[0][a]);
+        if (second_d >= 0 && second_score > -FLT_MAX) {
+            search_greedy_action(agents, a, agent->x + dirs[second_d][0], agent->y + dirs[second_d][1], &second[a]);
+            has_second[a] = true;
+        }
+    }
+
+    int count = 1;
+    for (int a = start; a <= stop && count < SEARCH_BRANCH; a++) {
+        if (!has_second[a]) continue;
+        memcpy(out[count], out[0], sizeof(out[0]));
+        out[count][a] = second[a];
+        count++;
+    }
+    return count;
+}
+
+static bool search_check_timeout() {
+    if ((++search.node_count & 63) == 0 && TURN_MS_USED > schedule.search_ms) search.timeout = true;
+    return search.timeout;
+}
+
+static float search_node(AgentState* agents, int depth, float alpha, float beta) {
+    // Valeur max-min d'un état avec depth tours restants ; agents[] est rendu inchangé
+    PROFILE_COUNT(COUNTER_SEARCH_NODES, 1);
+    if (depth == 0) return evaluate_state(agents);
+    if (search_check_timeout()) return 0.0f;
+
+    int my_id = game.consts.my_player_id;
+    int en_id = !my_id;
+    bool my_alive = false, en_alive = false;
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        if (!agents[i].alive) continue;
+        if (game.consts.agent_info[i].player_id == my_id) my_alive = true;
+        else en_alive = true;
+    }
+    if (!my_alive || !en_alive) return evaluate_state(agents);
+
+    uint64_t key = zobrist_hash(agents);
+    TTEntry* entry = &search.tt[key & ((1 << TT_BITS) - 1)];
+    if (entry->key == key && entry->generation == search.generation && entry->depth >= depth) {
+        if (entry->bound == TT_EXACT ||
+            (entry->bound == TT_LOWER && entry->value >= beta) ||
+            (entry->bound == TT_UPPER && entry->value <= alpha)) {
+            search.tt_hits++;
+            return entry->value;
+        }
+    }
+
+    AgentCommand my_cmds[SEARCH_BRANCH][MAX_AGENTS];
+    AgentCommand en_cmds[SEARCH_BRANCH][MAX_AGENTS];
+    int my_count = search_generate_commands(agents, my_id, my_cmds);
+    int en_count = search_generate_commands(agents, en_id, en_cmds);
+
+    float alpha_start = alpha;
+    float best = -FLT_MAX;
+    for (int m = 0; m < my_count; m++) {
+        float worst = FLT_MAX;
+        for (int e = 0; e < en_count; e++) {
+            const AgentCommand* cmds[MAX_AGENTS];
+            for (int i = 0; i < MAX_AGENTS; i++)
+                cmds[i] = (game.consts.agent_info[i].player_id == my_id) ? &my_cmds[m][i] : &en_cmds[e][i];
+
+            TurnUndo undo;
+            turn_make(agents, cmds, &undo);
+            float v = search_node(agents, depth - 1, alpha, worst < beta ? worst : beta);
+            turn_unmake(agents, &undo);
+            if (search.timeout) return 0.0f;
+            if (v < worst) worst = v;
+            if (worst <= alpha) break; // cette commande ne battra pas la meilleure
+        }
+        if (worst > best) best = worst;
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
     }
 
-    // Tri décroissant
-    for (int a = 0; a < game.output.simulation_count - 1; a++) {
-        for (int b = a + 1; b < game.output.simulation_count; b++) {
-            if (game.output.simulation_results[b].score > game.output.simulation_results[a].score) {
-                SimulationResult tmp = game.output.simulation_results[a];
-                game.output.simulation_results[a] = game.output.simulation_results[b];
-                game.output.simulation_results[b] = tmp;
+    entry->key = key;
+    entry->value = best;
+    entry->depth = depth;
+    entry->generation = search.generation;
+    entry->bound = (best <= alpha_start) ? TT_UPPER : (best >= beta) ? TT_LOWER : TT_EXACT;
+    return best;
+}
+
+void compute_search() {
+    PROFILE_SCOPE(PHASE_SEARCH);
+    // Approfondissement itératif : la profondeur 1 est le résultat de compute_evaluation(),
+    // chaque profondeur complète remplace la meilleure commande
+    int my_id = game.consts.my_player_id;
+    int en_id = !my_id;
+    int roots = game.output.simulation_count < SEARCH_ROOT_WIDTH ? game.output.simulation_count : SEARCH_ROOT_WIDTH;
+    int order[SEARCH_ROOT_WIDTH];
+    for (int k = 0; k < roots; k++) order[k] = k;
+
+    search.generation++;
+    search.timeout = false;
+    search.depth = 1;
+    search.node_count = 0;
+    search.tt_hits = 0;
+    int best = 0;
+    AgentState agents[MAX_AGENTS];
+    memcpy(agents, game.state.agents, sizeof(agents));
+
+    for (int depth = 2; depth <= schedule.search_depth && !search.timeout; depth++) {
+        float alpha = -FLT_MAX;
+        int iteration_best = -1;
+
+        for (int o = 0; o < roots; o++) {
+            int k = order[o];
+            int row = game.output.simulation_results[k].my_cmds_index;
+
+            // Réponses ennemies : la pire trouvée par la matrice, puis les premières heuristiques
+            int replies[SEARCH_ROOT_REPLIES];
+            int reply_count = 0;
+            replies[reply_count++] = game.output.simulation_results[k].op_cmds_index;
+            for (int c = 0; c < game.output.player_command_count[en_id] && reply_count < SEARCH_ROOT_REPLIES; c++)
+                if (c != replies[0]) replies[reply_count++] = c;
+
+            float worst = FLT_MAX;
+            for (int r = 0; r < reply_count; r++) {
+                const AgentCommand* cmds[MAX_AGENTS];
+                for (int i = 0; i < MAX_AGENTS; i++)
+                    cmds[i] = (game.consts.agent_info[i].player_id == my_id)
+                        ? player_command(my_id, row, i)
+                        : player_command(en_id, replies[r], i);
+
+                TurnUndo undo;
+                turn_make(agents, cmds, &undo);
+                float v = search_node(agents, depth - 1, alpha, worst);
+                turn_unmake(agents, &undo);
+                if (search.timeout) break;
+                if (v < worst) worst = v;
+                if (worst <= alpha) break;
+            }
+            if (search.timeout) break;
+            if (worst > alpha) {
+                alpha = worst;
+                iteration_best = o;
             }
         }
+        if (search.timeout || iteration_best < 0) break;
+
+        // Meilleure racine en tête pour la profondeur suivante
+        int k = order[iteration_best];
+        memmove(&order[1], &order[0], iteration_best * sizeof(int));
+        order[0] = k;
+        best = k;
+        search.depth = depth;
+    }
+
+    if (best != 0) {
+        SimulationResult tmp = game.output.simulation_results[0];
+        game.output.simulation_results[0] = game.output.simulation_results[best];
+        game.output.simulation_results[best] = tmp;
     }
 }
 
@@ -844,8 +2676,175 @@ void compute_evaluation() {
 
 
 
+#ifdef MCTS
+// ==========================
+// === MCTS
+// ==========================
+// Alternative à la matrice + recherche (compiler avec -DMCTS) : UCT découplé pour le tour
+// simultané. Chaque noeud garde des statistiques séparées par joueur ; chacun choisit son action
+// par UCB1 sur ses propres statistiques, l'enfant est celui du couple d'actions. À la racine, les
+// actions sont les premières combinaisons des tables de commandes joueur ; plus bas, celles de
+// search_generate_commands(), régénérées à chaque passage (l'état d'un noeud est déterministe).
+// Une feuille est évaluée par evaluate_state() à sa première visite et développée à la suivante.
+// Tous les noeuds viennent des pools de mcts : aucun malloc pendant le tour.
+
+static int mcts_new_node() {
+    if (mcts.node_count == MCTS_MAX_NODES) return -1;
+    MctsNode* node = &mcts.nodes[mcts.node_count];
+    *node = (MctsNode){ .visits = 0, .stats = -1, .children = -1 };
+    return mcts.node_count++;
+}
+
+static bool mcts_expand(MctsNode* node, int my_actions, int en_actions) {
+    int stats = my_actions + en_actions;
+    int children = my_actions * en_actions;
+    if (mcts.stat_count + stats > (int)(sizeof(mcts.stats) / sizeof(MctsStat))) return false;
+    if (mcts.child_count + children > (int)(sizeof(mcts.children) / sizeof(int))) return false;
+    node->stats = mcts.stat_count;
+    node->children = mcts.child_count;
+    node->action_counts[0] = my_actions;
+    node->action_counts[1] = en_actions;
+    memset(&mcts.stats[node->stats], 0, stats * sizeof(MctsStat));
+    for (int c = 0; c < children; c++) mcts.children[node->children + c] = -1;
+    mcts.stat_count += stats;
+    mcts.child_count += children;
+    return true;
+}
+
+static int mcts_select(const MctsNode* node, int side) {
+    // UCB1 sur les moyennes normalisées du joueur ; actions non essayées d'abord, dans l'ordre
+    const MctsStat* stats = &mcts.stats[node->stats + (side ? node->action_counts[0] : 0)];
+    float range = mcts.value_max - mcts.value_min;
+    float log_visits = logf((float)node->visits);
+    int best = 0;
+    float best_score = -FLT_MAX;
+    for (int i = 0; i < node->action_counts[side]; i++) {
+        if (stats[i].visits == 0) return i;
+        float mean = range > 0.0f ? (stats[i].value_sum / stats[i].visits - mcts.value_min) / range : 0.5f;
+        if (side) mean = 1.0f - mean;
+        float score = mean + MCTS_EXPLORATION * sqrtf(log_visits / stats[i].visits);
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static bool mcts_game_over(const AgentState* agents) {
+    bool alive[MAX_PLAYERS] = {false, false};
+    for (int i = 0; i < MAX_AGENTS; i++)
+        if (agents[i].alive) alive[game.consts.agent_info[i].player_id] = true;
+    return !alive[0] || !alive[1];
+}
+
+static void mcts_iterate(AgentState* agents) {
+    // Descente, évaluation de la feuille, remontée ; agents[] est rendu inchangé
+    int my_id = game.consts.my_player_id;
+    int en_id = !my_id;
+    int path[MCTS_MAX_DEPTH + 1];
+    uint8_t chosen[MCTS_MAX_DEPTH][2];
+    TurnUndo undo[MCTS_MAX_DEPTH];
+    AgentCommand generated[MAX_PLAYERS][SEARCH_BRANCH][MAX_AGENTS];
+    int depth = 0;
+    int node = 0;
+
+    for (;;) {
+        MctsNode* n = &mcts.nodes[node];
+        path[depth] = node;
+        if (depth == MCTS_MAX_DEPTH || n->visits == 0 || mcts_game_over(agents)) break;
+
+        const AgentCommand* cmds[MAX_AGENTS];
+        if (depth == 0) {
+            if (n->children < 0) {
+                int my_count = game.output.player_command_count[my_id];
+                int en_count = game.output.player_command_count[en_id];
+                if (!mcts_expand(n, my_count < MCTS_ROOT_ACTIONS ? my_count : MCTS_ROOT_ACTIONS,
+                                    en_count < MCTS_ROOT_ACTIONS ? en_count : MCTS_ROOT_ACTIONS)) break;
+            }
+            chosen[depth][0] = mcts_select(n, 0);
+            chosen[depth][1] = mcts_select(n, 1);
+            for (int i = 0; i < MAX_AGENTS; i++)
+                cmds[i] = (game.consts.agent_info[i].player_id == my_id) ? player_command(my_id, chosen[depth][0], i)
+                                                                         : player_command(en_id, chosen[depth][1], i);
+        } else {
+            int my_count = search_generate_commands(agents, my_id, generated[0]);
+            int en_count = search_generate_commands(agents, en_id, generated[1]);
+            if (n->children < 0 && !mcts_expand(n, my_count, en_count)) break;
+            chosen[depth][0] = mcts_select(n, 0);
+            chosen[depth][1] = mcts_select(n, 1);
+            for (int i = 0; i < MAX_AGENTS; i++)
+                cmds[i] = (game.consts.agent_info[i].player_id == my_id) ? &generated[0][chosen[depth][0]][i]
+                                                                         : &generated[1][chosen[depth][1]][i];
+        }
+
+        turn_make(agents, cmds, &undo[depth]);
+        int* child = &mcts.children[n->children + chosen[depth][0] * n->action_counts[1] + chosen[depth][1]];
+        if (*child < 0) *child = mcts_new_node();
+        depth++;
+        if (*child < 0) {
+            path[depth] = -1; // pool plein : l'état atteint est évalué sans noeud
+            break;
+        }
+        node = *child;
+    }
+
+    float value = evaluate_state(agents);
+    if (value < mcts.value_min) mcts.value_min = value;
+    if (value > mcts.value_max) mcts.value_max = value;
+
+    if (path[depth] >= 0) mcts.nodes[path[depth]].visits++;
+    for (int d = depth - 1; d >= 0; d--) {
+        MctsNode* n = &mcts.nodes[path[d]];
+        n->visits++;
+        MctsStat* mine = &mcts.stats[n->stats + chosen[d][0]];
+        MctsStat* theirs = &mcts.stats[n->stats + n->action_counts[0] + chosen[d][1]];
+        mine->visits++;
+        mine->value_sum += value;
+        theirs->visits++;
+        theirs->value_sum += value;
+        turn_unmake(agents, &undo[d]);
+    }
+    PROFILE_COUNT(COUNTER_SEARCH_NODES, depth + 1);
+}
+
+void compute_mcts() {
+    PROFILE_SCOPE(PHASE_SEARCH);
+    mcts.node_count = mcts.stat_count = mcts.child_count = 0;
+    mcts.value_min = FLT_MAX;
+    mcts.value_max = -FLT_MAX;
+    mcts.iterations = 0;
+    mcts_new_node();
+
+    AgentState agents[MAX_AGENTS];
+    memcpy(agents, game.state.agents, sizeof(agents));
+    do {
+        mcts_iterate(agents);
+        mcts.iterations++;
+    } while ((mcts.iterations & 15) || (mcts.iterations < schedule.mcts_iterations && TURN_MS_USED < schedule.search_ms));
+
+    // Action la plus visitée de chaque joueur à la racine
+    const MctsNode* root = &mcts.nodes[0];
+    int best[2] = {0, 0};
+    for (int side = 0; side < 2 && root->stats >= 0; side++) {
+        const MctsStat* stats = &mcts.stats[root->stats + (side ? root->action_counts[0] : 0)];
+        for (int i = 1; i < root->action_counts[side]; i++)
+            if (stats[i].visits > stats[best[side]].visits) best[side] = i;
+    }
+    const MctsStat* chosen = root->stats >= 0 ? &mcts.stats[root->stats + best[0]] : NULL;
+    game.output.simulation_results[0] = (SimulationResult){
+        .score = chosen && chosen->visits ? chosen->value_sum / chosen->visits : 0.0f,
+        .my_cmds_index = best[0],
+        .op_cmds_index = best[1]
+    };
+    game.output.simulation_count = 1;
+}
+#endif
+
+
 void apply_output() {
-    float cpu=CPU_MS_USED;
+    PROFILE_SCOPE(PHASE_OUTPUT);
+    float turn_ms=TURN_MS_USED;
     int my_player_id = game.consts.my_player_id;
     int agent_start_id = game.consts.player_info[my_player_id].agent_start_index;
     int agent_stop_id = game.consts.player_info[my_player_id].agent_stop_index;
@@ -859,7 +2858,7 @@ void apply_output() {
 
     for (int agent_id = agent_start_id; agent_id <= agent_stop_id; agent_id++) {
         if(!game.state.agents[agent_id].alive) continue;
-        AgentCommand* cmd = &game.output.player_commands[my_player_id][best_index][agent_id];
+        const AgentCommand* cmd = player_command(my_player_id, best_index, agent_id);
 
         // Commencer par agentId+1 car le jeu attend un index demarrage en 1
         printf("%d", agent_id+1);
@@ -881,7 +2880,7 @@ void apply_output() {
         }
 
         // Optionnel : message de debug (par exemple)
-        printf(";MESSAGE %.2fms",cpu);
+        printf(";MESSAGE %.2fms",turn_ms);
 
         printf("\n");
         fflush(stdout);
@@ -891,34 +2890,520 @@ void apply_output() {
 
 
 
+// ==========================
+// === ORDONNANCEUR
+// ==========================
+// Chaque phase s'arrête proprement à son échéance, mesurée depuis le début du tour ; celles du
+// premier tour sont FIRST_TURN_SCALE fois plus longues. Les quantités de travail (combinaisons
+// explorées, matchs de la matrice, itérations du solveur) sont recalées après chaque tour sur le débit mesuré, pour
+// remplir SCHEDULE_FILL de la fenêtre de leur phase dans un tour normal : elles baissent si la
+// machine ralentit et remontent quand il reste du temps.
+
+void schedule_turn_start() {
+#ifdef FIXED_WORK
+    schedule.joint_ms = schedule.evaluation_ms = schedule.search_ms = DBL_MAX;
+#else
+    double scale = schedule.turn == 0 ? FIRST_TURN_SCALE : 1.0;
+    schedule.joint_ms = JOINT_DEADLINE_MS * scale;
+    schedule.evaluation_ms = EVAL_DEADLINE_MS * scale;
+    schedule.search_ms = SEARCH_DEADLINE_MS * scale;
+#endif
+    schedule.turn++;
+}
+
+static void schedule_adapt(int* amount, int done, double start_ms, double elapsed_ms, double deadline_ms, int low, int high) {
+    // done unités en elapsed_ms : quantité qui remplit la fenêtre [start_ms, deadline_ms] au prochain tour
+#ifndef FIXED_WORK
+    if (done <= 0 || elapsed_ms <= 0.0 || start_ms >= deadline_ms) return;
+    double target = done / elapsed_ms * (deadline_ms - start_ms) * SCHEDULE_FILL;
+    *amount = target < low ? low : target > high ? high : (int)target;
+#endif
+}
+
 // ==========================
 // === MAIN LOOP
 // ==========================
 
-int main() {
-    read_game_inputs_init();
+void plan_turn() {
+    schedule_turn_start();
 
-    while (1) {
-        fprintf(stderr,"current\n");
-        // ========== Lecture des entrées
-        read_game_inputs_cycle();
+    // ========== Liste des meilleures commandes par agent ==========
+    precompute_occupancy();
+    precompute_control_map();
+    compute_best_agents_commands();
 
-        // ========== Liste des meilleures commandes par agent ==========
-        precompute_bfs_distances();
-        compute_best_agents_commands();
+    // ========== Combinaisons possibles entre agents ==========
+    double start = TURN_MS_USED;
+    compute_best_player_commands();
+    int my_id = game.consts.my_player_id;
+    schedule_adapt(&schedule.combo_budget, (game.output.player_command_count[my_id] + game.output.player_command_count[!my_id]) / 2,
+                   start, TURN_MS_USED - start, JOINT_DEADLINE_MS, JOINT_MIN_COMBOS, MAX_COMMANDS_PER_PLAYER);
+
+#ifdef MCTS
+    // ========== Recherche Monte Carlo (remplace évaluation et recherche) ==========
+    compute_mcts();
+#else
+    // ========== Évaluation stratégique ==========
+    start = TURN_MS_USED;
+    compute_evaluation();
+#if EVAL_MODE == EVAL_REGRET
+    schedule_adapt(&schedule.regret_iterations, regret.iterations, start, TURN_MS_USED - start, EVAL_DEADLINE_MS,
+                   REGRET_MIN_ITERATIONS, REGRET_MAX_ITERATIONS);
+#else
+    schedule_adapt(&schedule.matchup_budget, game.output.matchup_count, start, TURN_MS_USED - start, EVAL_DEADLINE_MS,
+                   EVAL_MIN_MATCHUPS, EVAL_MAX_MATCHUPS);
+#endif
+
+    // ========== Recherche sur plusieurs tours ==========
+#if EVAL_MODE != EVAL_REGRET
+    // Le max-min de la recherche remplacerait le choix pondéré par l'équilibre du solveur
+    compute_search();
+#endif
+#endif
+    warm_start_save();
+}
 
-        // ========== Combinaisons possibles entre agents ==========
-        compute_best_player_commands();
+void play_turn() {
+    plan_turn();
 
-        // ========== Évaluation stratégique ==========
-        compute_evaluation();
+    // ========== Application ==========
+    apply_output();
+}
 
-        // ========== Application ==========
-        apply_output();
+#ifdef BENCH
+// ==========================
+// === BENCH
+// ==========================
+// Rejoue des tours enregistrés : transcript stdin capturé par capture.sh, ou enregistrements
+// binaires RECORD_DIR (lus par mmap). Chaque tour passe iterations fois (100 par défaut) dans le
+// pipeline avec les quantités de travail FIXED_* et sans échéance, puis min / médiane / p99 par
+// phase et simulations par seconde.
+// Usage : ./bench.out [iterations] < transcript.txt
+//         ./bench.out iterations partie1.scr partie2.scr ...
 
-        debug_stats();
+typedef struct {
+    uint64_t* data;
+    size_t count, capacity;
+} BenchSamples;
+
+typedef struct {
+    BenchSamples phases[PHASE_COUNT];
+    BenchSamples totals;
+    uint64_t sims, busy_ns;
+    int turns;
+} BenchStats;
+
+static void bench_push(BenchSamples* samples, uint64_t value) {
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 1024;
+        samples->data = realloc(samples->data, samples->capacity * sizeof(uint64_t));
+        if (!samples->data) ERROR("bench out of memory");
+    }
+    samples->data[samples->count++] = value;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t va = *(const uint64_t*)a, vb = *(const uint64_t*)b;
+    return (va > vb) - (va < vb);
+}
+
+static void bench_print(const char* name, BenchSamples* samples) {
+    if (samples->count == 0) return;
+    qsort(samples->data, samples->count, sizeof(uint64_t), compare_u64);
+    size_t p99 = samples->count * 99 / 100;
+    if (p99 >= samples->count) p99 = samples->count - 1;
+    fprintf(stderr, "BENCH %-12s min_us=%10.3f median_us=%10.3f p99_us=%10.3f n=%zu\n", name,
+            samples->data[0] / 1e3, samples->data[samples->count / 2] / 1e3, samples->data[p99] / 1e3, samples->count);
+}
+
+static void bench_turn(BenchStats* stats, int iterations) {
+    // Le tour courant vient d'être lu dans game.state
+    bench_push(&stats->phases[PHASE_READ], profile.phase_ns[PHASE_READ]);
+    for (int it = 0; it < iterations; it++) {
+        memset(profile.phase_ns, 0, sizeof(profile.phase_ns));
+        memset(profile.counters, 0, sizeof(profile.counters));
+        // Chaque itération rejoue le tour à l'identique : pas de plan ni de budget hérités
+        memset(warm, 0, sizeof(warm));
+        schedule_reset();
+        TURN_RESET;
+        uint64_t start = now_ns();
+        play_turn();
+        uint64_t elapsed = now_ns() - start;
+        profile_flush_counters();
+
+        for (int p = 0; p < PHASE_COUNT; p++)
+            if (p != PHASE_READ) bench_push(&stats->phases[p], profile.phase_ns[p]);
+        bench_push(&stats->totals, elapsed);
+        stats->sims += profile.counters[COUNTER_SIMULATIONS];
+        stats->busy_ns += elapsed;
+    }
+    stats->turns++;
+    memset(&profile, 0, sizeof(profile));
+}
+
+int main(int argc, char** argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 100;
+    if (!freopen("/dev/null", "w", stdout)) ERROR("cannot redirect stdout");
+
+    BenchStats stats = {0};
+    search_init();
+#if EVAL_POOL
+    evaluation_pool_init();
+#endif
+    memset(&profile, 0, sizeof(profile));
+
+    if (argc > 2) {
+        for (int f = 2; f < argc; f++) {
+            RecordReader reader;
+            if (!record_open(&reader, argv[f])) {
+                fprintf(stderr, "BENCH cannot open %s\n", argv[f]);
+                continue;
+            }
+            if (record_read_init(&reader)) {
+                while (record_read_turn(&reader)) bench_turn(&stats, iterations);
+            }
+            record_close(&reader);
+        }
+    } else {
+        read_game_inputs_init();
+        while (read_game_inputs_cycle()) bench_turn(&stats, iterations);
+    }
+
+    fprintf(stderr, "BENCH turns=%d iterations=%d\n", stats.turns, iterations);
+    for (int p = 0; p < PHASE_COUNT; p++) bench_print(profile_phase_names[p], &stats.phases[p]);
+    bench_print("turn", &stats.totals);
+    fprintf(stderr, "BENCH sims=%llu sims_per_s=%.0f\n", (unsigned long long)stats.sims,
+            stats.busy_ns ? stats.sims * 1e9 / stats.busy_ns : 0.0);
+    return 0;
+}
+#elif defined(SELFPLAY)
+// ==========================
+// === SELF-PLAY
+// ==========================
+// Moteur natif avec les règles complètes (déplacements et collisions, tirs avec portée et
+// couverture, hunker, bombes, élimination, score de territoire) et tournoi sans arbitre Java :
+// notre pipeline joue les deux sièges, chaque graine est jouée deux fois en inversant les côtés,
+// les matchs sont répartis sur des processus fils. Sortie au format de `Main stat`.
+// Usage : ./selfplay.out [matchs=200] [processus=nproc] [agent1.params] [agent2.params]
+
+#define ENGINE_MAX_TURNS 100
+#define ENGINE_SCORE_LEAD 600       // avance de points qui termine la partie
+#define ENGINE_STAT_SEED 12345      // graine du tirage des cartes, comme Main stat
+
+typedef struct {
+    GameConstants consts;           // constantes complètes, my_player_id fixé au tour de chaque siège
+    AgentState agents[MAX_AGENTS];
+    int score[MAX_PLAYERS];
+    int turn;
+} EngineGame;
+
+typedef struct {
+    int agent1_wins, agent2_wins, ties, games;
+} SelfplayTally;
+
+// Classes d'agents : id, player_id, shoot_cooldown, optimal_range, soaking_power, splash_bombs
+static const AgentInfo engine_classes[] = {
+    {0, 0, 1, 4, 16, 1},   // gunner
+    {0, 0, 5, 6, 24, 0},   // sniper
+    {0, 0, 2, 2, 8, 3},    // bomber
+    {0, 0, 2, 4, 16, 2},   // assault
+    {0, 0, 5, 2, 32, 1},   // berserker
+};
+
+void engine_generate(EngineGame* g, uint64_t seed) {
+    // Carte symétrique (miroir horizontal), colonnes de départ dégagées, mêmes classes des deux côtés
+    uint64_t rng = seed ^ 0x9E3779B97F4A7C15ULL;
+    memset(g, 0, sizeof(*g));
+    MapInfo* map = &g->consts.map;
+    map->height = 6 + random_next(&rng) % 5;
+    map->width = 2 * map->height;
+    for (int y = 0; y < map->height; y++) {
+        for (int x = 0; x < map->width / 2; x++) {
+            int type = 0;
+            if (x > 0 && random_next(&rng) % 100 < 12) type = 1 + random_next(&rng) % 2;
+            map->map[y][x] = (Tile){x, y, type};
+            map->map[y][map->width - 1 - x] = (Tile){map->width - 1 - x, y, type};
+        }
+    }
+
+    int per_player = 2 + random_next(&rng) % (MAX_AGENTS / 2 - 1);
+    int rows[MAX_HEIGHT];
+    for (int y = 0; y < map->height; y++) rows[y] = y;
+    for (int y = map->height - 1; y > 0; y--) {
+        int k = random_next(&rng) % (y + 1);
+        int t = rows[y]; rows[y] = rows[k]; rows[k] = t;
+    }
+    *(int*)&g->consts.agent_info_count = 2 * per_player;
+    for (int i = 0; i < per_player; i++) {
+        AgentInfo cls = engine_classes[random_next(&rng) % (sizeof(engine_classes) / sizeof(engine_classes[0]))];
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            int aid = p * per_player + i;
+            int x = p ? map->width - 1 : 0;
+            g->consts.agent_info[aid] = cls;
+            g->consts.agent_info[aid].id = aid;
+            g->consts.agent_info[aid].player_id = p;
+            g->agents[aid] = (AgentState){aid, x, rows[i], 0, cls.splash_bombs, 0, 1};
+        }
+    }
+
+    // Données dérivées (infos par joueur, bitboards) calculées par le code du bot
+    memcpy((void*)&game.consts, &g->consts, sizeof(game.consts));
+    setup_game_constants();
+    memcpy((void*)&g->consts, &game.consts, sizeof(game.consts));
+}
+
+void engine_play_turn(EngineGame* g, const AgentCommand* const cmds[MAX_AGENTS]) {
+    // Règles du tour partagées avec le bot (turn_make), puis score de territoire
+    memcpy((void*)&game.consts, &g->consts, sizeof(game.consts));
+    const MapInfo* map = &g->consts.map;
+    AgentState* agents = g->agents;
+    TurnUndo undo;
+    turn_make(agents, cmds, &undo);
+
+    // === Territoire : tuile à l'agent le plus proche (distance doublée à 50 de wetness)
+    int tiles[MAX_PLAYERS] = {0};
+    for (int y = 0; y < map->height; y++) {
+        for (int x = 0; x < map->width; x++) {
+            if (map->map[y][x].type != 0) continue;
+            int best[MAX_PLAYERS] = {INT_MAX, INT_MAX};
+            for (int a = 0; a < MAX_AGENTS; a++) {
+                if (!agents[a].alive) continue;
+                int d = abs(agents[a].x - x) + abs(agents[a].y - y);
+                if (agents[a].wetness >= 50) d *= 2;
+                int p = g->consts.agent_info[a].player_id;
+                if (d < best[p]) best[p] = d;
+            }
+            if (best[0] < best[1]) tiles[0]++;
+            else if (best[1] < best[0]) tiles[1]++;
+        }
+    }
+    if (tiles[0] > tiles[1]) g->score[0] += tiles[0] - tiles[1];
+    else if (tiles[1] > tiles[0]) g->score[1] += tiles[1] - tiles[0];
+    g->turn++;
+}
 
+int engine_winner(const EngineGame* g) {
+    // -1 partie en cours, 0 / 1 vainqueur, 2 égalité
+    int alive[MAX_PLAYERS] = {0};
+    for (int a = 0; a < MAX_AGENTS; a++)
+        if (g->agents[a].alive) alive[g->consts.agent_info[a].player_id]++;
+    if (alive[0] && !alive[1]) return 0;
+    if (alive[1] && !alive[0]) return 1;
+    // Élimination simultanée, avance décisive ou dernier tour : au score
+    if (!alive[0] || abs(g->score[0] - g->score[1]) >= ENGINE_SCORE_LEAD || g->turn >= ENGINE_MAX_TURNS)
+        return g->score[0] > g->score[1] ? 0 : g->score[1] > g->score[0] ? 1 : 2;
+    return -1;
+}
+
+static void selfplay_seat_commands(const EngineGame* g, int seat, const Params* seat_params,
+                                   AgentCommand commands[MAX_AGENTS], const AgentCommand* cmds[MAX_AGENTS]) {
+    // Le pipeline du bot joue le siège comme s'il avait lu l'état de l'arbitre
+    params = *seat_params;
+    memcpy((void*)&game.consts, &g->consts, sizeof(game.consts));
+    *(int*)&game.consts.my_player_id = seat;
+    memcpy(game.state.agents, g->agents, sizeof(game.state.agents));
+    game.state.agent_count_do_not_use = game.state.my_agent_count_do_not_use = 0;
+    for (int a = 0; a < MAX_AGENTS; a++) {
+        if (!g->agents[a].alive) continue;
+        game.state.agent_count_do_not_use++;
+        if (g->consts.agent_info[a].player_id == seat) game.state.my_agent_count_do_not_use++;
+    }
+
+    TURN_RESET;
+    plan_turn();
+    if (game.output.simulation_count == 0) return;
+    int best = game.output.simulation_results[0].my_cmds_index;
+    for (int a = game.consts.player_info[seat].agent_start_index; a <= game.consts.player_info[seat].agent_stop_index; a++) {
+        if (!g->agents[a].alive) continue;
+        commands[a] = *player_command(seat, best, a);
+        cmds[a] = &commands[a];
+    }
+}
+
+int selfplay_game(uint64_t seed, const Params seat_params[MAX_PLAYERS], int scores[MAX_PLAYERS]) {
+    EngineGame g;
+    engine_generate(&g, seed);
+    int winner;
+    while ((winner = engine_winner(&g)) < 0) {
+        AgentCommand commands[MAX_AGENTS];
+        const AgentCommand* cmds[MAX_AGENTS] = {0};
+        for (int seat = 0; seat < MAX_PLAYERS; seat++)
+            selfplay_seat_commands(&g, seat, &seat_params[seat], commands, cmds);
+        engine_play_turn(&g, cmds);
+    }
+    scores[0] = g.score[0];
+    scores[1] = g.score[1];
+    return winner;
+}
+
+static void selfplay_worker(int worker, int workers, int matches, uint64_t seed,
+                            const Params agent_params[MAX_PLAYERS], int fd) {
+    // Matchs worker, worker + workers, ... ; les graines sont tirées dans le même ordre partout
+    SelfplayTally tally = {0};
+    uint64_t rng = seed;
+    for (int m = 0; m < matches; m++) {
+        uint64_t game_seed = random_next(&rng);
+        if (m % workers != worker) continue;
+        for (int agent1_seat = 0; agent1_seat < MAX_PLAYERS; agent1_seat++) {
+            Params seat_params[MAX_PLAYERS];
+            seat_params[agent1_seat] = agent_params[0];
+            seat_params[!agent1_seat] = agent_params[1];
+            int scores[MAX_PLAYERS];
+            int winner = selfplay_game(game_seed, seat_params, scores);
+            if (winner == 2) tally.ties++;
+            else if (winner == agent1_seat) tally.agent1_wins++;
+            else tally.agent2_wins++;
+            tally.games++;
+        }
+    }
+    if (write(fd, &tally, sizeof(tally)) != sizeof(tally)) ERROR("selfplay pipe");
+}
+
+SelfplayTally selfplay_run(int matches, int workers, uint64_t seed, const Params agent_params[MAX_PLAYERS]) {
+    // Agent 1 contre agent 2 sur matches graines (deux parties chacune), workers processus fils
+    if (workers > matches) workers = matches > 0 ? matches : 1;
+    int fds[workers];
+    for (int w = 0; w < workers; w++) {
+        int pipefd[2];
+        if (pipe(pipefd) != 0) ERROR("pipe");
+        pid_t pid = fork();
+        if (pid < 0) ERROR("fork");
+        if (pid == 0) {
+            close(pipefd[0]);
+            // Traces du bot (stderr) inutiles ici
+            if (!freopen("/dev/null", "w", stderr)) ERROR("cannot redirect stderr");
+            search_init();
+#if EVAL_POOL
+            evaluation_pool_init();
+#endif
+            selfplay_worker(w, workers, matches, seed, agent_params, pipefd[1]);
+            _exit(0);
+        }
+        close(pipefd[1]);
+        fds[w] = pipefd[0];
+    }
+
+    SelfplayTally total = {0};
+    for (int w = 0; w < workers; w++) {
+        SelfplayTally tally;
+        if (read(fds[w], &tally, sizeof(tally)) == sizeof(tally)) {
+            total.agent1_wins += tally.agent1_wins;
+            total.agent2_wins += tally.agent2_wins;
+            total.ties += tally.ties;
+            total.games += tally.games;
+        }
+        close(fds[w]);
+    }
+    while (wait(NULL) > 0) {}
+    return total;
+}
+
+static int default_workers() {
+    int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return workers < 1 ? 1 : workers;
+}
+
+#ifdef TUNE
+// ==========================
+// === TUNER
+// ==========================
+// SPSA sur le bloc Params : à chaque itération, toutes les valeurs sont perturbées ensemble
+// (±c_k relatif à la valeur par défaut, signes aléatoires), theta+ joue theta- sur matchs
+// graines en parallèle, et theta avance dans la direction gagnante. Les valeurs courantes
+// sont réécrites dans tune.params à chaque itération (reprise : passer ce fichier au départ).
+// Usage : ./tune.out [itérations=200] [matchs=64] [processus=nproc] [départ.params]
+#define TUNE_A 0.05            // pas initial (unités relatives)
+#define TUNE_C 0.10            // perturbation initiale (unités relatives)
+#define TUNE_STABILITY 10.0    // retarde la décroissance du pas
+#define TUNE_OUTPUT "tune.params"
+
+int main(int argc, char** argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    int matches = (argc > 2) ? atoi(argv[2]) : 64;
+    int workers = (argc > 3) ? atoi(argv[3]) : default_workers();
+    if (workers < 1) workers = 1;
+
+    const Params defaults = PARAMS_DEFAULT;
+    Params theta = defaults;
+    if (argc > 4 && !params_load(&theta, argv[4])) ERROR("cannot read start parameters");
+
+    uint64_t rng = ENGINE_STAT_SEED;
+    for (int k = 1; k <= iterations; k++) {
+        double c = TUNE_C / pow(k, 0.101);
+        double a = TUNE_A / pow(k + TUNE_STABILITY, 0.602);
+        int delta[PARAM_COUNT];
+        Params candidates[MAX_PLAYERS] = {theta, theta};
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            float scale = fabsf(((const float*)&defaults)[i]);
+            delta[i] = (random_next(&rng) & 1) ? 1 : -1;
+            ((float*)&candidates[0])[i] += (float)(c * scale * delta[i]);
+            ((float*)&candidates[1])[i] -= (float)(c * scale * delta[i]);
+        }
+
+        uint64_t start = now_ns();
+        SelfplayTally tally = selfplay_run(matches, workers, random_next(&rng), candidates);
+        double r = tally.games ? (double)(tally.agent1_wins - tally.agent2_wins) / tally.games : 0.0;
+
+        // Gradient estimé r / (2c) par coordonnée, en unités relatives à la valeur par défaut
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            float scale = fabsf(((const float*)&defaults)[i]);
+            ((float*)&theta)[i] += (float)(a * r / (2.0 * c) * delta[i] * scale);
+        }
+
+        printf("TUNE iter=%d games=%d plus=%d minus=%d ties=%d r=%+.3f c=%.3f a=%.4f %.1fs\n", k, tally.games,
+               tally.agent1_wins, tally.agent2_wins, tally.ties, r, c, a, (now_ns() - start) / 1e9);
+        params_save(&theta, stdout);
+        fflush(stdout);
+        FILE* file = fopen(TUNE_OUTPUT, "w");
+        if (file) {
+            params_save(&theta, file);
+            fclose(file);
+        }
+    }
+    return 0;
+}
+#else
+int main(int argc, char** argv) {
+    int matches = (argc > 1) ? atoi(argv[1]) : 200;
+    int workers = (argc > 2) ? atoi(argv[2]) : default_workers();
+    if (workers < 1) workers = 1;
+    Params agent_params[MAX_PLAYERS] = {PARAMS_DEFAULT, PARAMS_DEFAULT};
+    for (int p = 0; p < MAX_PLAYERS; p++)
+        if (argc > 3 + p && !params_load(&agent_params[p], argv[3 + p])) ERROR("cannot read agent parameters");
+
+    uint64_t start = now_ns();
+    SelfplayTally total = selfplay_run(matches, workers, ENGINE_STAT_SEED, agent_params);
+    double seconds = (now_ns() - start) / 1e9;
+
+    int games = total.games ? total.games : 1;
+    printf("Games: %d in %.2fs (%.1f games/s, %d processes)\n", total.games, seconds, total.games / seconds,
+           workers < matches ? workers : matches);
+    printf("\nFinal Statistics:\n");
+    printf("Agent 1 Win Percentage: %.2f%%\n", total.agent1_wins * 100.0 / games);
+    printf("Agent 2 Win Percentage: %.2f%%\n", total.agent2_wins * 100.0 / games);
+    printf("Tie Percentage: %.2f%%\n", total.ties * 100.0 / games);
+    return 0;
+}
+#endif
+#else
+int main() {
+    const char* params_path = getenv("PARAMS");
+    if (params_path && !params_load(&params, params_path)) ERROR("cannot read PARAMS");
+    read_game_inputs_init();
+    search_init();
+#if EVAL_POOL
+    evaluation_pool_init();
+#endif
+
+    // ========== Lecture des entrées
+    while (read_game_inputs_cycle()) {
+        fprintf(stderr,"current\n");
+        play_turn();
+
+        debug_stats();
+        profile_report();
     }
 
     return 0;
 }
+#endif